@@ -0,0 +1,30 @@
+
+#ifndef __CLCD_SERVICE_H__
+#define __CLCD_SERVICE_H__
+
+#include <l4lib/types.h>
+#include <l4lib/fb.h>
+#include <dev/clcd.h>
+
+/*
+ * Colour lcd with two framebuffers, one of which is shown while
+ * the owner draws into the other. A present waits in pending
+ * until the controller has taken the new buffer.
+ */
+struct clcd {
+	unsigned long base;		/* VMA where clcd will be mapped */
+	unsigned long phys_base;
+	int irq_no;			/* IRQ number of device */
+	int slot;			/* Notify slot on utcb */
+	l4id_t irq_tid;			/* Thread that tells us of flips */
+	const struct clcd_mode *mode;
+
+	unsigned long buf_phys[2];
+	void *buf[2];			/* Uncached, as the controller reads */
+	int front;			/* Buffer being shown */
+
+	l4id_t owner;			/* Task that draws, or L4_NILTHREAD */
+	int pending;			/* A present waits for its flip */
+};
+
+#endif /* __CLCD_SERVICE_H__ */
@@ -0,0 +1,9 @@
+#ifndef __LINKER_H__
+#define __LINKER_H__
+
+extern char vma_start[];
+extern char lma_start[];
+extern char offset[];
+extern char __end[];
+
+#endif /* __LINKER_H__ */
@@ -0,0 +1,399 @@
+/*
+ * Colour lcd framebuffer service for userspace
+ *
+ * The service owns two framebuffers and maps both of them to the
+ * task that attaches, uncached as it has them itself. That task
+ * writes its changes into the back buffer and presents it. Pixels
+ * never go through ipc, nor through the service: a present only
+ * moves the controller to the other buffer at the next vertical
+ * sync.
+ */
+#include <l4lib/macros.h>
+#include L4LIB_INC_ARCH(syslib.h)
+#include <l4lib/lib/addr.h>
+#include <l4lib/lib/thread.h>
+#include <l4lib/lib/cap.h>
+#include <l4lib/irq.h>
+#include <l4lib/ipcdefs.h>
+#include <l4lib/fb.h>
+#include <l4/api/errno.h>
+#include <l4/api/irq.h>
+#include <l4/api/capability.h>
+#include <l4/generic/cap-types.h>
+#include <l4/api/space.h>
+#include <mem/malloc.h>
+#include <string.h>
+#include <container.h>
+#include <linker.h>
+#include <clcd.h>
+#include <dev/platform.h>
+
+static struct capability *caparray;
+static int total_caps = 0;
+
+static struct clcd clcd;
+
+/* Thread that takes requests, and is told of flips */
+l4id_t tid_ipc_handler;
+
+int cap_share_all_with_space()
+{
+	int err;
+
+	/* Share all capabilities */
+	if ((err = l4_capability_control(CAP_CONTROL_SHARE,
+					 CAP_SHARE_ALL_SPACE, 0)) < 0) {
+		printf("l4_capability_control() sharing of "
+		       "capabilities failed.\n Could not "
+		       "complete CAP_CONTROL_SHARE request. err=%d\n",
+		       err);
+		BUG();
+	}
+
+	return 0;
+}
+
+int clcd_irq_handler(void *arg)
+{
+	struct clcd *clcd = (struct clcd *)arg;
+	unsigned int irqs;
+	int err;
+
+	/*
+	 * Register batched, so that the line stays masked
+	 * until we have cleared the controller and ack it.
+	 */
+	if ((err = l4_irq_control(IRQ_CONTROL_REGISTER,
+				  clcd->slot | IRQ_CONTROL_BATCHED,
+				  clcd->irq_no)) < 0) {
+		printf("%s: FATAL: Clcd irq could not be registered. "
+		       "err=%d\n", __FUNCTION__, err);
+		BUG();
+	}
+
+	/* Handle irqs forever */
+	while (1) {
+		/* Ack the last irq and block on the next */
+		if ((err = l4_irq_ack_wait(clcd->irq_no)) < 0) {
+			printf("l4_irq_ack_wait() returned with negative value\n");
+			BUG();
+		}
+		l4_irq_slot_count(clcd->slot);
+
+		irqs = clcd_irq_status(clcd->base);
+
+		/*
+		 * The controller raises this every frame, so
+		 * it is only on while a present waits for it.
+		 */
+		if (irqs & CLCD_IRQ_FLIP) {
+			clcd_irq_disable(clcd->base, CLCD_IRQ_FLIP);
+			l4_send(tid_ipc_handler, L4_IPC_TAG_FB_FLIPPED);
+		}
+	}
+}
+
+/*
+ * Declare a statically allocated char buffer
+ * with enough bitmap size to cover given size
+ */
+#define DECLARE_IDPOOL(name, size)      \
+char name[(sizeof(struct id_pool) + ((size >> 12) >> 3))]
+
+/* Device page, and both buffers with room to align them */
+#define PAGE_POOL_SIZE                  (3 * FB_WINDOW_SIZE)
+static struct address_pool device_vaddr_pool;
+DECLARE_IDPOOL(device_id_pool, PAGE_POOL_SIZE);
+
+/*
+ * Initialize a virtual address pool
+ * for mapping physical devices.
+ */
+void init_vaddr_pool(void)
+{
+	for (int i = 0; i < total_caps; i++) {
+		/* Find the virtual memory region for this process */
+		if (cap_type(&caparray[i]) == CAP_TYPE_MAP_VIRTMEM
+		    && __pfn_to_addr(caparray[i].start) ==
+		    (unsigned long)vma_start) {
+
+			/*
+			 * Do we have any unused virtual space
+			 * where we run, and do we have enough
+			 * pages of it to map the device and
+			 * both framebuffers?
+			 */
+			if (__pfn(page_align_up(__end)) +
+			    __pfn(PAGE_POOL_SIZE) <= caparray[i].end) {
+				/*
+				 * Yes. We initialize the device
+				 * virtual memory pool here.
+				 *
+				 * We may allocate virtual memory
+				 * addresses from this pool.
+				 */
+				address_pool_init(&device_vaddr_pool,
+						  (struct id_pool *)&device_id_pool,
+						  page_align_up(__end),
+						  page_align_up(__end) +
+						  PAGE_POOL_SIZE);
+				return;
+			} else
+				goto out_err;
+		}
+	}
+
+out_err:
+	printf("%s: FATAL: No virtual memory "
+	       "region available to map "
+	       "devices.\n", __CONTAINER_NAME__);
+	BUG();
+}
+
+void *l4_new_virtual(int npages)
+{
+	return address_new(&device_vaddr_pool, npages, PAGE_SIZE);
+}
+
+/*
+ * Framebuffers are taken from the top of our physical memory.
+ * They are mapped uncached, as the controller reads them from
+ * memory, and together aligned to their size so that both go out
+ * as one flexpage.
+ */
+void clcd_setup_buffers(struct clcd *clcd)
+{
+	struct capability *physmem = cap_get_physmem(CAP_TYPE_MAP_PHYSMEM);
+	unsigned long image_end, end;
+	void *window;
+
+	if (!physmem) {
+		printf("%s: FATAL: No physical memory for "
+		       "framebuffers.\n", __CONTAINER_NAME__);
+		BUG();
+	}
+
+	image_end = page_align_up((unsigned long)__end -
+				  (unsigned long)offset);
+	end = __pfn_to_addr(physmem->end) & ~(FB_BUFFER_SIZE - 1);
+
+	if (end < 2 * FB_BUFFER_SIZE ||
+	    end - 2 * FB_BUFFER_SIZE < image_end ||
+	    end - 2 * FB_BUFFER_SIZE < __pfn_to_addr(physmem->start)) {
+		printf("%s: FATAL: Physical memory too small for "
+		       "framebuffers.\n", __CONTAINER_NAME__);
+		BUG();
+	}
+
+	window = l4_new_virtual(__pfn(2 * FB_WINDOW_SIZE));
+	window = (void *)align_up(window, FB_WINDOW_SIZE);
+
+	for (int i = 0; i < 2; i++) {
+		clcd->buf_phys[i] = end - (2 - i) * FB_BUFFER_SIZE;
+		clcd->buf[i] = window + i * FB_BUFFER_SIZE;
+
+		if (IS_ERR(l4_map((void *)clcd->buf_phys[i], clcd->buf[i],
+				  __pfn(FB_BUFFER_SIZE), MAP_USR_IO,
+				  self_tid()))) {
+			printf("%s: FATAL: Failed to map framebuffer "
+			       "to a virtual address\n",
+			       __CONTAINER_NAME__);
+			BUG();
+		}
+
+		memset(clcd->buf[i], 0, clcd_size(clcd->mode));
+	}
+}
+
+int clcd_setup_devices(void)
+{
+	struct l4_thread thread;
+	struct l4_thread *tptr = &thread;
+	int err;
+
+	clcd.phys_base = PLATFORM_CLCD0_BASE;
+	clcd.irq_no = IRQ_CLCD0;
+	clcd.slot = 0;
+	clcd.mode = &clcd_mode_vga;
+	clcd.owner = L4_NILTHREAD;
+
+	/* Get one page from address pool */
+	clcd.base = (unsigned long)l4_new_virtual(1);
+
+	/* Map clcd to a virtual address region */
+	if (IS_ERR(l4_map((void *)clcd.phys_base, (void *)clcd.base, 1,
+			  MAP_USR_IO, self_tid()))) {
+		printf("%s: FATAL: Failed to map Clcd device "
+		       "to a virtual address\n",
+		       __CONTAINER_NAME__);
+		BUG();
+	}
+
+	clcd_setup_buffers(&clcd);
+
+	/* Show a blank front buffer */
+	clcd.front = 0;
+	clcd_init(clcd.base, clcd.mode, clcd.buf_phys[clcd.front]);
+	printf("%s: %dx%d display initialization done..\n",
+	       __CONTAINER_NAME__, clcd.mode->width, clcd.mode->height);
+
+	/*
+	 * Create new clcd irq handler thread.
+	 *
+	 * This will register itself as the clcd irq handler,
+	 * and tell us of each flip the controller makes.
+	 */
+	if ((err = thread_create(clcd_irq_handler, &clcd,
+				 TC_SHARE_SPACE, &tptr)) < 0) {
+		printf("FATAL: Creation of irq handler "
+		       "thread failed.\n");
+		BUG();
+	}
+	clcd.irq_tid = tptr->ids.tid;
+
+	return 0;
+}
+
+static void clcd_reply(l4id_t tid, int retval)
+{
+	int err;
+
+	l4_set_sender(tid);
+	if ((err = l4_ipc_return(retval)) < 0)
+		printf("%s: IPC return error: %d.\n", __FUNCTION__, err);
+}
+
+/*
+ * Makes the sender the owner of the display. Both buffers go to
+ * it as one uncached item with the reply, into the window it waits
+ * on, so the attach is over in the one ipc. There is one owner for
+ * the life of the service.
+ */
+void fb_attach(l4id_t sender)
+{
+	int err;
+
+	if (clcd.owner != L4_NILTHREAD) {
+		clcd_reply(sender, -EBUSY);
+		return;
+	}
+
+	/* Mode, and the buffer to draw into first as return value */
+	write_mr(L4SYS_ARG0, clcd.mode->width | clcd.mode->height << 16);
+	write_mr(L4SYS_ARG1, clcd_stride(clcd.mode));
+
+	l4_set_sender(sender);
+	if ((err = l4_ipc_return_map(!clcd.front,
+				     l4_fpage((unsigned long)clcd.buf[0],
+					      FB_WINDOW_ORDER,
+					      L4_FPAGE_WRITE |
+					      L4_FPAGE_UNCACHED))) < 0) {
+		printf("%s: Framebuffers could not be mapped to "
+		       "0x%x. err=%d\n", __CONTAINER__, sender, err);
+		return;
+	}
+
+	clcd.owner = sender;
+}
+
+/*
+ * Moves the controller to the back buffer. The owner is replied
+ * to once it has been taken, as until then the front buffer is
+ * still being read.
+ */
+int fb_present(l4id_t sender)
+{
+	if (sender != clcd.owner)
+		return -EPERM;
+	if (clcd.pending)
+		return -EBUSY;
+
+	clcd.pending = 1;
+	clcd_set_base(clcd.base, clcd.buf_phys[!clcd.front]);
+	clcd_irq_enable(clcd.base, CLCD_IRQ_FLIP);
+
+	return 0;
+}
+
+/*
+ * The controller shows what was the back buffer, so the owner
+ * may write out to the other one.
+ */
+void fb_flipped(void)
+{
+	if (!clcd.pending)
+		return;
+
+	clcd.front = !clcd.front;
+	clcd.pending = 0;
+	clcd_reply(clcd.owner, !clcd.front);
+}
+
+void handle_requests(void)
+{
+	l4id_t senderid;
+	u32 tag;
+	int ret;
+
+	if ((ret = l4_receive(L4_ANYTHREAD)) < 0) {
+		printf("%s: %s: IPC Error: %d. Quitting...\n", __CONTAINER__,
+		       __FUNCTION__, ret);
+		BUG();
+	}
+
+	/* Syslib conventional ipc data which uses first few mrs. */
+	tag = l4_get_tag();
+	senderid = l4_get_sender();
+
+	switch (tag) {
+	case L4_IPC_TAG_FB_ATTACH:
+		/* Replies with the buffers */
+		fb_attach(senderid);
+		return;
+	case L4_IPC_TAG_FB_PRESENT:
+		/* Replied to on the flip */
+		if ((ret = fb_present(senderid)) == 0)
+			return;
+		break;
+	case L4_IPC_TAG_FB_FLIPPED:
+		if (senderid == clcd.irq_tid) {
+			fb_flipped();
+			return;
+		}
+		ret = -EPERM;
+		break;
+	default:
+		printf("%s: Error received ipc from 0x%x residing "
+		       "in container %x with an unrecognized tag: "
+		       "0x%x\n", __CONTAINER__, senderid,
+		       __cid(senderid), tag);
+		ret = -EINVAL;
+	}
+
+	/* Reply */
+	clcd_reply(senderid, ret);
+}
+
+void main(void)
+{
+	/* Read all capabilities */
+	caps_read_all();
+
+	total_caps = cap_get_count();
+	caparray = cap_get_all();
+
+	/* Share all with space */
+	cap_share_all_with_space();
+
+	/* Initialize virtual address pool for the device and buffers */
+	init_vaddr_pool();
+
+	tid_ipc_handler = self_tid();
+
+	/* Map and initialize the display */
+	clcd_setup_devices();
+
+	/* Listen for framebuffer requests */
+	while (1)
+		handle_requests();
+}
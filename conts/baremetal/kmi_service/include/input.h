@@ -0,0 +1,16 @@
+/*
+ * Input event subscribers.
+ */
+#ifndef __KMI_INPUT_H__
+#define	__KMI_INPUT_H__
+
+#include <l4lib/input.h>
+#include <l4lib/ring.h>
+
+/* Clients taking events at a time, each on a channel port */
+#define SUBSCRIBERS_TOTAL	4
+
+/* Most events moved on one irq */
+#define INPUT_BATCH_MAX		32
+
+#endif /* __KMI_INPUT_H__ */
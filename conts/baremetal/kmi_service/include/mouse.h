@@ -4,13 +4,21 @@
 #ifndef __MOUSE_H__
 #define	__MOUSE_H__
 
+/* Bits of the first byte of a mouse packet */
+#define MOUSE_PACKET_SYNC	(1 << 3)	/* Always set */
+#define MOUSE_PACKET_XSIGN	(1 << 4)
+#define MOUSE_PACKET_YSIGN	(1 << 5)
+#define MOUSE_PACKET_BUTTONS	0x7
+
 /*
- * Keyboard structure
+ * Mouse structure
  */
 struct mouse {
 	unsigned long base;	/* Virtual base address */
 	unsigned long phys_base;  /* Physical address of device */
 	int irq_no;	/* IRQ number of device */
+	unsigned char packet[3];	/* Packet being received */
+	int npacket;		/* Bytes of it so far */
 };
 
 #endif /* __MOUSE_H__ */
@@ -1,11 +1,18 @@
 /*
  * Keyboard and Mouse service for userspace
+ *
+ * Key presses and mouse packets are decoded by the irq threads
+ * into timestamped events, and queued to every subscriber in a
+ * ring it shares with the service. All events of an irq go with
+ * at most one notification per subscriber.
  */
 #include <l4lib/lib/addr.h>
 #include <l4lib/lib/thread.h>
 #include <l4lib/lib/cap.h>
 #include <l4lib/irq.h>
 #include <l4lib/ipcdefs.h>
+#include <l4lib/mutex.h>
+#include <l4lib/time.h>
 #include <l4/api/errno.h>
 #include <l4/api/irq.h>
 #include <l4/api/capability.h>
@@ -16,6 +23,7 @@
 #include <linker.h>
 #include <keyboard.h>
 #include <mouse.h>
+#include <input.h>
 #include <dev/platform.h>
 
 #define KEYBOARDS_TOTAL		1
@@ -27,6 +35,18 @@ static int total_caps = 0;
 struct keyboard kbd[KEYBOARDS_TOTAL];
 struct mouse mouse[MOUSE_TOTAL];
 
+/* Subscribers, woken on the slots they asked for */
+static struct l4_channel_port subscriber[SUBSCRIBERS_TOTAL];
+
+/* Events lost to a full ring, per subscriber */
+static unsigned int subscriber_dropped[SUBSCRIBERS_TOTAL];
+
+/*
+ * Serializes the irq threads, as they share subscriber rings,
+ * and keeps them off rings that are being released.
+ */
+static L4_MUTEX(subscriber_lock);
+
 int cap_share_all_with_space()
 {
 	int err;
@@ -44,6 +64,78 @@ int cap_share_all_with_space()
 	return 0;
 }
 
+/*
+ * Queues a batch of events to all subscribers, and wakes each
+ * one that sleeps once. Events that find a ring full are lost
+ * to that subscriber only. Rings are written by their subscribers
+ * too, so they are filled by the layout they had when accepted, and
+ * a subscriber found gone on wakeup is dropped.
+ * Returns the number of subscribers.
+ */
+static int input_post(struct input_event *ev, int nev)
+{
+	struct l4_channel_port *sub;
+	int nsubs = 0;
+
+	l4_mutex_lock(&subscriber_lock);
+
+	for (int i = 0; i < SUBSCRIBERS_TOTAL; i++) {
+		sub = &subscriber[i];
+		if (!sub->ring)
+			continue;
+		nsubs++;
+
+		for (int j = 0; j < nev; j++)
+			if (l4_channel_send(&sub->ch, &ev[j]) < 0)
+				subscriber_dropped[i]++;
+
+		if (l4_channel_flush(&sub->ch) == -ESRCH)
+			l4_channel_release(sub);
+	}
+
+	l4_mutex_unlock(&subscriber_lock);
+
+	return nsubs;
+}
+
+static void input_stamp(struct input_event *ev, int nev)
+{
+	u32 sec, usec;
+
+	l4_gettime(&sec, &usec);
+
+	for (int i = 0; i < nev; i++) {
+		ev[i].sec = sec;
+		ev[i].usec = usec;
+	}
+}
+
+/*
+ * Builds an event from a mouse packet once all three of its bytes
+ * are in. Bytes are dropped until one that can start a packet, so
+ * that a lost byte does not shift all later packets.
+ */
+static int mouse_packet_read(struct mouse *mouse, unsigned char data,
+			     struct input_event *ev)
+{
+	unsigned char *p = mouse->packet;
+
+	if (!mouse->npacket && !(data & MOUSE_PACKET_SYNC))
+		return 0;
+
+	p[mouse->npacket++] = data;
+	if (mouse->npacket < 3)
+		return 0;
+	mouse->npacket = 0;
+
+	ev->type = INPUT_EV_MOUSE;
+	ev->code = p[0] & MOUSE_PACKET_BUTTONS;
+	ev->dx = (p[0] & MOUSE_PACKET_XSIGN) ? (int)p[1] - 256 : p[1];
+	ev->dy = (p[0] & MOUSE_PACKET_YSIGN) ? (int)p[2] - 256 : p[2];
+
+	return 1;
+}
+
 int keyboard_irq_handler(void *arg)
 {
 	int err;
@@ -68,13 +160,34 @@ int keyboard_irq_handler(void *arg)
 
 	/* Handle irqs forever */
 	while (1) {
+		struct input_event ev[INPUT_BATCH_MAX];
+		int nev = 0;
 		char c;
 
 		/* Block on irq */
-		int data = l4_irq_wait(slot, keyboard->irq_no);
-		while (data--)
-			if ((c = kmi_keyboard_read(keyboard->base, &keyboard->state)))
-				printf("%c", c);
+		if ((err = l4_irq_wait(slot, keyboard->irq_no)) < 0) {
+			printf("l4_irq_wait() returned with negative value\n");
+			BUG();
+		}
+
+		while (nev < INPUT_BATCH_MAX &&
+		       kmi_data_pending(keyboard->base)) {
+			if (!(c = kmi_keyboard_read(keyboard->base,
+						    &keyboard->state)))
+				continue;
+
+			ev[nev].type = INPUT_EV_KEY;
+			ev[nev].code = (unsigned char)c;
+			ev[nev].dx = 0;
+			ev[nev].dy = 0;
+			nev++;
+		}
+
+		/* Echo keys if nobody takes them */
+		input_stamp(ev, nev);
+		if (nev && !input_post(ev, nev))
+			for (int i = 0; i < nev; i++)
+				printf("%c", ev[i].code);
 
 		/*
 		 * Kernel has disabled irq for keyboard
@@ -108,13 +221,25 @@ int mouse_irq_handler(void *arg)
 
 	/* Handle irqs forever */
 	while (1) {
-		int c;
+		struct input_event ev[INPUT_BATCH_MAX];
+		int nev = 0;
 
 		/* Block on irq */
-		int data = l4_irq_wait(slot, mouse->irq_no);
-		while (data--)
-			if ((c = kmi_data_read(mouse->base)))
-				printf("mouse data: %d\n", c);
+		if ((err = l4_irq_wait(slot, mouse->irq_no)) < 0) {
+			printf("l4_irq_wait() returned with negative value\n");
+			BUG();
+		}
+
+		while (nev < INPUT_BATCH_MAX && kmi_data_pending(mouse->base))
+			nev += mouse_packet_read(mouse,
+						 kmi_data_read(mouse->base),
+						 &ev[nev]);
+
+		input_stamp(ev, nev);
+		if (nev && !input_post(ev, nev))
+			for (int i = 0; i < nev; i++)
+				printf("mouse: buttons 0x%x dx %d dy %d\n",
+				       ev[i].code, ev[i].dx, ev[i].dy);
 
 		/*
 		 * Kernel has disabled irq for mouse
@@ -166,6 +291,12 @@ int kmi_setup_devices(void)
 		}
 	}
 
+	/* Windows for the rings of subscribers */
+	for (int i = 0; i < SUBSCRIBERS_TOTAL; i++) {
+		subscriber[i].window = l4_new_virtual(1);
+		subscriber[i].order = INPUT_RING_ORDER;
+	}
+
 	mouse[0].phys_base = PLATFORM_MOUSE0_BASE;
 	mouse[0].irq_no = IRQ_MOUSE0;
 
@@ -227,10 +358,12 @@ void init_vaddr_pool(void)
 			/*
 			 * Do we have any unused virtual space
 			 * where we run, and do we have enough
-			 * pages of it to map all timers?
+			 * pages of it to map all devices, and
+			 * the rings of subscribers?
 			 */
 			if (__pfn(page_align_up(__end)) + KEYBOARDS_TOTAL +
-			    MOUSE_TOTAL <= caparray[i].end) {
+			    MOUSE_TOTAL + SUBSCRIBERS_TOTAL <=
+			    caparray[i].end) {
 				/*
 				 * Yes. We initialize the device
 				 * virtual memory pool here.
@@ -260,15 +393,71 @@ void *l4_new_virtual(int npages)
 	return address_new(&device_vaddr_pool, npages, PAGE_SIZE);
 }
 
+/*
+ * Accepts the sender as a subscriber that is woken on the given
+ * notify slot, taking the ring page that came with the request.
+ * Events go to it from the next irq on.
+ */
+int input_subscribe(l4id_t sender, int slot, unsigned int fpage)
+{
+	struct l4_channel_port *sub;
+
+	if (!(sub = l4_channel_accept(subscriber, SUBSCRIBERS_TOTAL,
+				      sender, fpage,
+				      sizeof(struct input_event))))
+		return -EINVAL;
+
+	if (slot < 0 || slot >= TASK_NOTIFY_SLOTS) {
+		l4_channel_release(sub);
+		return -EINVAL;
+	}
+
+	sub->ch.slot = slot;
+	subscriber_dropped[sub - subscriber] = 0;
+	l4_channel_publish(sub);
+
+	return 0;
+}
+
+int input_unsubscribe(l4id_t sender)
+{
+	struct l4_channel_port *sub;
+
+	if (!(sub = l4_channel_find(subscriber, SUBSCRIBERS_TOTAL, sender)))
+		return -ENOENT;
+
+	l4_mutex_lock(&subscriber_lock);
+	l4_channel_release(sub);
+	l4_mutex_unlock(&subscriber_lock);
+
+	return 0;
+}
+
 void handle_requests(void)
 {
 	u32 mr[MR_UNUSED_TOTAL];
+	unsigned int window, fpage;
 	l4id_t senderid;
 	u32 tag;
 	int ret;
 
+	/* With all ports taken, those of exited subscribers are freed */
+	if (!(window = l4_channel_window(subscriber, SUBSCRIBERS_TOTAL))) {
+		l4_mutex_lock(&subscriber_lock);
+		l4_channel_reap(subscriber, SUBSCRIBERS_TOTAL);
+		l4_mutex_unlock(&subscriber_lock);
+		window = l4_channel_window(subscriber, SUBSCRIBERS_TOTAL);
+	}
+
+	/*
+	 * A free port takes the ring page of a subscribe. With none
+	 * free, or a page the sender cannot pass on, the kernel refuses
+	 * the item, which fails our receive as well as the sender's ipc.
+	 */
 	printf("%s: Initiating ipc.\n", __CONTAINER__);
-	if ((ret = l4_receive(L4_ANYTHREAD)) < 0) {
+	if ((ret = l4_receive_map(L4_ANYTHREAD, window, &fpage)) < 0) {
+		if (ret == -ENOIPC || ret == -EFAULT)
+			return;
 		printf("%s: %s: IPC Error: %d. Quitting...\n", __CONTAINER__,
 		       __FUNCTION__, ret);
 		BUG();
@@ -294,11 +483,18 @@ void handle_requests(void)
 	 * inside the current container
 	 */
 	switch (tag) {
+	case L4_IPC_TAG_INPUT_SUBSCRIBE:
+		ret = input_subscribe(senderid, mr[0], fpage);
+		break;
+	case L4_IPC_TAG_INPUT_UNSUBSCRIBE:
+		ret = input_unsubscribe(senderid);
+		break;
 	default:
 		printf("%s: Error received ipc from 0x%x residing "
 		       "in container %x with an unrecognized tag: "
 		       "0x%x\n", __CONTAINER__, senderid,
 		       __cid(senderid), tag);
+		ret = -EINVAL;
 	}
 
 	/* Reply */
@@ -4,6 +4,40 @@
 
 #include <l4/api/capability.h>
 #include <l4/generic/cap-types.h>
+#include <l4/lib/list.h>
+#include <l4lib/mutex.h>
+#include <l4lib/types.h>
+#include <l4lib/uart.h>
+#include <l4lib/console.h>
+
+/*
+ * Byte rings between the irq thread and the request thread.
+ * Head and tail are free running, each written by one side.
+ */
+#define UART_TX_RING_SIZE	SZ_4K
+#define UART_RX_RING_SIZE	SZ_1K
+
+struct uart_ring {
+	volatile u32 head;
+	volatile u32 tail;
+	u32 size;		/* Power of two */
+	char *data;
+};
+
+/*
+ * A request that could not be completed at once. Writers keep
+ * their unqueued bytes, readers wait for input or a deadline.
+ */
+struct uart_request {
+	struct link list;
+	l4id_t tid;
+	u32 tag;
+	unsigned int flags;
+	unsigned int size;
+	unsigned int done;
+	u32 deadline;		/* In ms, if UART_TIMEOUT */
+	char buf[UART_SENDBUF_MAX];
+};
 
 /*
  * uart structure ecapsulating
@@ -12,6 +46,25 @@
 struct uart {
 	unsigned long base; /* VMA where uart will be mapped */
 	unsigned long phys_base;
+	int irq_no;		/* IRQ number of device */
+	int slot;		/* Notify slot on utcb */
+
+	struct uart_ring tx;
+	struct uart_ring rx;
+	struct l4_mutex tx_lock;	/* Tx ring consumers, irq mask */
+	unsigned int rx_dropped;	/* Input lost to a full rx ring */
+
+	/* Requests waiting on the rings, in arrival order */
+	struct link writers;
+	struct link readers;
+	volatile int tx_waiting;
+	volatile int rx_waiting;
 };
 
+/* Requests that a client may have parked at a time */
+#define UART_CLIENT_REQUESTS_MAX	4
+
+/* Tasks that may log to the console at a time */
+#define CONSOLE_CLIENTS_MAX	8
+
 #endif /* __UART_SERVICE_H__ */
@@ -1,17 +1,40 @@
 /*
  * UART service for userspace
+ *
+ * The uart is run off its rx/tx interrupts with fifos enabled.
+ * An irq thread moves bytes between the fifos and two rings, and
+ * the request thread serves clients from the rings a buffer at a
+ * time. Requests that cannot complete at once are parked until
+ * the irq thread, or for timed receives the timeout thread, calls
+ * the request thread back.
+ *
+ * The service is also the console that tasks log to. A console
+ * thread prints the lines that attached tasks queue in their ring
+ * pages, tagged with thread and time, as ordinary sends. A ring
+ * page comes as a map item with the attach request, and is unmapped
+ * on detach, or once its task is found to be gone.
  */
 #include <l4lib/macros.h>
 #include L4LIB_INC_ARCH(syslib.h)
 #include L4LIB_INC_ARCH(syscalls.h)
+#include L4LIB_INC_ARCH(barrier.h)
 #include <l4lib/exregs.h>
 #include <l4lib/lib/addr.h>
 #include <l4lib/lib/cap.h>
+#include <l4lib/lib/thread.h>
 #include <l4lib/ipcdefs.h>
+#include <l4lib/irq.h>
+#include <l4lib/time.h>
+#include <l4lib/ring.h>
+#include <l4lib/console.h>
 #include <l4/api/errno.h>
+#include <l4/api/irq.h>
 #include <l4/api/capability.h>
 #include <l4/generic/cap-types.h>
 #include <l4/api/space.h>
+#include <l4/lib/math.h>
+#include <mem/malloc.h>
+#include <string.h>
 #include <container.h>
 #include <linker.h>
 #include <uart.h>
@@ -26,15 +49,618 @@ static int total_caps = 0;
 #define UARTS_TOTAL             1
 static struct uart uart[UARTS_TOTAL];
 
+static char uart_tx_data[UARTS_TOTAL][UART_TX_RING_SIZE];
+static char uart_rx_data[UARTS_TOTAL][UART_RX_RING_SIZE];
+
+/* Receive replies are copied out of here */
+static char recv_buf[UART_RECVBUF_MAX];
+
+/* tid of handle_request thread */
+l4id_t tid_ipc_handler;
+
+/* Timed receives, see uart_timeout_handler() */
+#define TIMEOUT_REARM		(1 << L4_NOTIFY_IRQ_BITS)
+static l4id_t tid_timeout;
+static volatile int timeout_armed;
+static volatile u32 timeout_next;
+
+/* Console log, see uart_console_handler() */
+#define CONSOLE_SLOT		0
+static l4id_t tid_console;
+static struct l4_channel_port console_port[CONSOLE_CLIENTS_MAX];
+
+/* Whether the last entry printed of a port was part of a line */
+static int console_partial[CONSOLE_CLIENTS_MAX];
+
+/* Keeps the console thread off rings that are being released */
+static L4_MUTEX(console_lock);
+
+/* Deadlines are in wrapping ms, compare them by distance */
+#define time_after_eq(a, b)	((int)((a) - (b)) >= 0)
+
+static u32 uart_time_ms(void)
+{
+	u32 sec, usec;
+
+	l4_gettime(&sec, &usec);
+
+	return sec * 1000 + usec / 1000;
+}
+
+static void uart_ring_init(struct uart_ring *ring, char *data, u32 size)
+{
+	ring->head = 0;
+	ring->tail = 0;
+	ring->size = size;
+	ring->data = data;
+}
+
+static inline u32 uart_ring_used(struct uart_ring *ring)
+{
+	return ring->head - ring->tail;
+}
+
+static inline u32 uart_ring_free(struct uart_ring *ring)
+{
+	return ring->size - uart_ring_used(ring);
+}
+
+/* Producer side: queues as much of buf as fits */
+static int uart_ring_put(struct uart_ring *ring, const char *buf, int size)
+{
+	u32 head = ring->head;
+	int n = min(uart_ring_free(ring), size);
+
+	for (int i = 0; i < n; i++)
+		ring->data[(head + i) & (ring->size - 1)] = buf[i];
+
+	/* Bytes must be in place before they are published */
+	l4_smp_mb();
+	ring->head = head + n;
+
+	return n;
+}
+
+/* Consumer side: takes as much as there is, up to size */
+static int uart_ring_get(struct uart_ring *ring, char *buf, int size)
+{
+	u32 tail = ring->tail;
+	int n = min(uart_ring_used(ring), size);
+
+	for (int i = 0; i < n; i++)
+		buf[i] = ring->data[(tail + i) & (ring->size - 1)];
+
+	l4_smp_mb();
+	ring->tail = tail + n;
+
+	return n;
+}
+
+/*
+ * Moves queued bytes into the tx fifo until it fills, and leaves
+ * the tx irq on only while there are more. Called by both threads,
+ * so the tx ring has two consumers and takes a lock.
+ */
+static void uart_tx_fill(struct uart *uart)
+{
+	struct uart_ring *tx = &uart->tx;
+
+	l4_mutex_lock(&uart->tx_lock);
+
+	while (uart_ring_used(tx) && !uart_tx_full(uart->base)) {
+		uart_tx_char(uart->base, tx->data[tx->tail & (tx->size - 1)]);
+		tx->tail++;
+	}
+
+	if (uart_ring_used(tx))
+		uart_irq_enable(uart->base, UART_IRQ_TX);
+	else
+		uart_irq_disable(uart->base, UART_IRQ_TX);
+
+	l4_mutex_unlock(&uart->tx_lock);
+}
+
+/*
+ * Drains the rx fifo. Input that finds the ring full is dropped,
+ * as leaving it in the fifo would keep the irq asserted.
+ */
+static void uart_rx_drain(struct uart *uart)
+{
+	struct uart_ring *rx = &uart->rx;
+	char c;
+
+	while (!uart_rx_empty(uart->base)) {
+		c = uart_rx_char(uart->base);
+
+		if (!uart_ring_free(rx)) {
+			uart->rx_dropped++;
+			continue;
+		}
+		rx->data[rx->head & (rx->size - 1)] = c;
+		l4_smp_mb();
+		rx->head++;
+	}
+}
+
+/*
+ * Irq handler for uart interrupts
+ */
+int uart_irq_handler(void *arg)
+{
+	struct uart *uart = (struct uart *)arg;
+	unsigned int irqs;
+	int err;
+
+	/*
+	 * Register self for uart irq. The line is batched, so it
+	 * stays masked until we have drained the uart and ack it.
+	 */
+	if ((err = l4_irq_control(IRQ_CONTROL_REGISTER,
+				  uart->slot | IRQ_CONTROL_BATCHED,
+				  uart->irq_no)) < 0) {
+		printf("%s: FATAL: Uart irq could not be registered. "
+		       "err=%d\n", __FUNCTION__, err);
+		BUG();
+	}
+
+	uart_irq_enable(uart->base, UART_IRQ_RX);
+
+	/* Handle irqs forever */
+	while (1) {
+		/* Ack the last irq and block on the next */
+		if ((err = l4_irq_ack_wait(uart->irq_no)) < 0) {
+			printf("l4_irq_ack_wait() returned with negative value\n");
+			BUG();
+		}
+		l4_irq_slot_count(uart->slot);
+
+		irqs = uart_irq_status(uart->base);
+
+		if (irqs & UART_IRQ_RX)
+			uart_rx_drain(uart);
+		if (irqs & UART_IRQ_TX)
+			uart_tx_fill(uart);
+
+		/*
+		 * Call back the request thread only if it has requests
+		 * parked on the ring we moved. It sets the flag before
+		 * its last look at the ring, so either it sees our bytes
+		 * or we see its flag.
+		 */
+		l4_smp_mb();
+		if (((irqs & UART_IRQ_RX) && uart->rx_waiting) ||
+		    ((irqs & UART_IRQ_TX) && uart->tx_waiting))
+			l4_send(tid_ipc_handler, L4_IPC_TAG_UART_IRQ);
+	}
+}
+
+/*
+ * Sleeps until the earliest timed receive is due, then has the
+ * request thread fail the expired ones. The sleep is a timed
+ * signal wait, which the request thread cuts short to rearm for
+ * an earlier deadline. Deadlines are kept to scheduler ticks.
+ */
+int uart_timeout_handler(void *arg)
+{
+	unsigned int bits;
+	u32 now;
+	int err;
+
+	while (1) {
+		if (!timeout_armed) {
+			err = l4_signal_wait(TIMEOUT_REARM, &bits);
+		} else if (time_after_eq((now = uart_time_ms()),
+					 timeout_next)) {
+			/* Returns after expired reads are failed */
+			l4_sendrecv(tid_ipc_handler, tid_ipc_handler,
+				    L4_IPC_TAG_UART_TIMEOUT);
+			continue;
+		} else {
+			err = l4_signal_wait_timeout(TIMEOUT_REARM, &bits,
+						     timeout_next - now);
+		}
+
+		if (err < 0 && err != -ETIMEDOUT) {
+			printf("l4_signal_wait() returned with %d\n", err);
+			BUG();
+		}
+	}
+}
+
+static void uart_timeout_arm(u32 deadline)
+{
+	if (timeout_armed && time_after_eq(deadline, timeout_next))
+		return;
+
+	timeout_next = deadline;
+	l4_smp_mb();
+	timeout_armed = 1;
+
+	/* The pending bit makes the thread look at the new deadline */
+	l4_signal(tid_timeout, TIMEOUT_REARM);
+}
+
+/* Prints an entry, with its tag if it starts a line */
+static void console_print(int port, struct console_entry *entry)
+{
+	char buf[32 + CONSOLE_LINE_MAX + 1];
+	int len = min(entry->len, CONSOLE_LINE_MAX);
+	int n = 0;
+
+	if (!console_partial[port]) {
+		if (entry->tid == L4_NILTHREAD)
+			n = sprintf(buf, "[%5u.%06u] -: ",
+				    entry->sec, entry->usec);
+		else
+			n = sprintf(buf, "[%5u.%06u] %x: ",
+				    entry->sec, entry->usec, entry->tid);
+	}
+
+	memcpy(buf + n, entry->text, len);
+	n += len;
+
+	console_partial[port] = entry->flags & CONSOLE_PARTIAL;
+	if (!console_partial[port])
+		buf[n++] = '\n';
+
+	l4_uart_send(tid_ipc_handler, buf, n, 0);
+}
+
+/*
+ * Takes the next entry of a port, if its ring is there. The ring
+ * is read by the layout it had when accepted, whatever its task
+ * writes to it since. Printing is left out of the lock, as it is
+ * an ipc to the request thread, which takes the lock to release
+ * rings.
+ */
+static int console_get(int port, struct console_entry *entry)
+{
+	int err = -EAGAIN;
+
+	l4_mutex_lock(&console_lock);
+	if (console_port[port].ring)
+		err = l4_channel_poll(&console_port[port].ch, entry);
+	l4_mutex_unlock(&console_lock);
+
+	return err;
+}
+
+/*
+ * Prints the rings of attached tasks, and sleeps on its notify
+ * slot once all are empty. It is about to sleep on every ring
+ * before it looks at them once more, so that a task either sees
+ * that or its line is seen, as with l4_channel_receive(). Rings
+ * of tasks that exited without detaching are dropped on the way,
+ * before their pages can be handed out again.
+ */
+int uart_console_handler(void *arg)
+{
+	struct console_entry entry;
+	struct l4_ring *ring;
+	int busy;
+
+	while (1) {
+		busy = 0;
+
+		for (int i = 0; i < CONSOLE_CLIENTS_MAX; i++) {
+			while (console_get(i, &entry) == 0) {
+				console_print(i, &entry);
+				busy = 1;
+			}
+		}
+
+		if (busy)
+			continue;
+
+		l4_mutex_lock(&console_lock);
+
+		l4_channel_reap(console_port, CONSOLE_CLIENTS_MAX);
+
+		for (int i = 0; i < CONSOLE_CLIENTS_MAX; i++)
+			if ((ring = console_port[i].ring))
+				ring->waiting = 1;
+
+		l4_smp_mb();
+
+		for (int i = 0; i < CONSOLE_CLIENTS_MAX; i++)
+			if ((ring = console_port[i].ring) &&
+			    ring->head != ring->tail)
+				busy = 1;
+
+		l4_mutex_unlock(&console_lock);
+
+		if (busy)
+			continue;
+
+		if (l4_notify_wait(CONSOLE_SLOT) < 0) {
+			printf("l4_notify_wait() returned with negative value\n");
+			BUG();
+		}
+	}
+}
+
+static void uart_reply(l4id_t tid, int retval)
+{
+	int err;
+
+	l4_set_sender(tid);
+	if ((err = l4_ipc_return(retval)) < 0)
+		printf("%s: IPC return error: %d.\n", __FUNCTION__, err);
+}
+
+/* Replies with retval bytes of recv_buf, or with an error */
+static void uart_reply_reader(l4id_t tid, u32 tag, int retval)
+{
+	int err;
+
+	if (tag == L4_IPC_TAG_UART_RECVCHAR) {
+		write_mr(L4SYS_ARG0, recv_buf[0]);
+		uart_reply(tid, retval < 0 ? retval : 0);
+		return;
+	}
+
+	l4_set_sender(tid);
+	if ((err = l4_return_extended(retval, retval, recv_buf,
+				      retval <= 0)) < 0)
+		printf("%s: IPC return error: %d.\n", __FUNCTION__, err);
+}
+
+static void uart_serve_readers(struct uart *uart)
+{
+	struct uart_request *req, *n;
+
+	list_foreach_removable_struct(req, n, &uart->readers, list) {
+		if (!uart_ring_used(&uart->rx))
+			break;
+
+		list_remove(&req->list);
+		uart_reply_reader(req->tid, req->tag,
+				  uart_ring_get(&uart->rx, recv_buf,
+						req->size));
+		kfree(req);
+	}
+
+	uart->rx_waiting = !list_empty(&uart->readers);
+}
+
+static void uart_serve_writers(struct uart *uart)
+{
+	struct uart_request *req, *n;
+
+	list_foreach_removable_struct(req, n, &uart->writers, list) {
+		req->done += uart_ring_put(&uart->tx, req->buf + req->done,
+					   req->size - req->done);
+		if (req->done < req->size)
+			break;
+
+		list_remove(&req->list);
+		uart_reply(req->tid, req->tag == L4_IPC_TAG_UART_SENDCHAR ?
+			   0 : req->size);
+		kfree(req);
+	}
+
+	uart_tx_fill(uart);
+
+	uart->tx_waiting = !list_empty(&uart->writers);
+}
+
+/* Fails timed reads whose deadline passed, and rearms for the rest */
+static void uart_expire_readers(struct uart *uart)
+{
+	struct uart_request *req, *n;
+	u32 now = uart_time_ms();
+	int armed = 0;
+	u32 next = 0;
+
+	list_foreach_removable_struct(req, n, &uart->readers, list) {
+		if (!(req->flags & UART_TIMEOUT))
+			continue;
+
+		if (time_after_eq(now, req->deadline)) {
+			list_remove(&req->list);
+			uart_reply_reader(req->tid, req->tag, -ETIMEDOUT);
+			kfree(req);
+		} else if (!armed || !time_after_eq(req->deadline, next)) {
+			next = req->deadline;
+			armed = 1;
+		}
+	}
+
+	timeout_next = next;
+	l4_smp_mb();
+	timeout_armed = armed;
+
+	uart->rx_waiting = !list_empty(&uart->readers);
+}
+
+/* Number of requests that tid has parked on the rings */
+static int uart_client_requests(struct uart *uart, l4id_t tid)
+{
+	struct uart_request *req;
+	int n = 0;
+
+	list_foreach_struct(req, &uart->writers, list)
+		if (req->tid == tid)
+			n++;
+	list_foreach_struct(req, &uart->readers, list)
+		if (req->tid == tid)
+			n++;
+
+	return n;
+}
+
+/*
+ * Allocates a request to park. Fails with -EBUSY if the client
+ * already has its share of parked requests, as each one holds a
+ * full send buffer, or with -ENOMEM if the heap is exhausted.
+ */
+static int uart_new_request(struct uart *uart, struct uart_request **reqp,
+			    l4id_t tid, u32 tag, unsigned int flags,
+			    unsigned int size)
+{
+	struct uart_request *req;
+
+	if (uart_client_requests(uart, tid) >= UART_CLIENT_REQUESTS_MAX)
+		return -EBUSY;
+
+	if (!(req = (struct uart_request *)
+	      kzalloc(sizeof(struct uart_request))))
+		return -ENOMEM;
+
+	link_init(&req->list);
+	req->tid = tid;
+	req->tag = tag;
+	req->flags = flags;
+	req->size = size;
+
+	*reqp = req;
+	return 0;
+}
+
+/*
+ * Queues the bytes of a send, in order behind any parked sends.
+ * A blocking send that does not fit is parked with its remainder.
+ */
+void uart_send(struct uart *uart, l4id_t sender, u32 tag,
+	       const char *buf, unsigned int size, unsigned int flags)
+{
+	struct uart_request *req;
+	int err, n = 0;
+
+	if (list_empty(&uart->writers))
+		n = uart_ring_put(&uart->tx, buf, size);
+	if (n)
+		uart_tx_fill(uart);
+
+	if (n == size) {
+		uart_reply(sender, tag == L4_IPC_TAG_UART_SENDCHAR ? 0 : n);
+		return;
+	}
+
+	if (flags & UART_NONBLOCK) {
+		uart_reply(sender, n ? n : -EAGAIN);
+		return;
+	}
+
+	/* Bytes that did go out are still reported */
+	if ((err = uart_new_request(uart, &req, sender, tag,
+				    flags, size)) < 0) {
+		uart_reply(sender, n ? n : err);
+		return;
+	}
+
+	memcpy(req->buf, buf, size);
+	req->done = n;
+	list_insert_tail(&req->list, &uart->writers);
+
+	uart->tx_waiting = 1;
+	l4_smp_mb();
+	uart_serve_writers(uart);
+}
+
+/*
+ * Returns what input there is, up to size. With none, a receive
+ * is failed if nonblocking, or parked until input or its deadline.
+ */
+void uart_recv(struct uart *uart, l4id_t sender, u32 tag,
+	       unsigned int size, unsigned int flags, u32 timeout_ms)
+{
+	struct uart_request *req;
+	int err;
+
+	if (size > UART_RECVBUF_MAX)
+		size = UART_RECVBUF_MAX;
+
+	if (list_empty(&uart->readers) && uart_ring_used(&uart->rx)) {
+		uart_reply_reader(sender, tag,
+				  uart_ring_get(&uart->rx, recv_buf, size));
+		return;
+	}
+
+	if ((flags & UART_NONBLOCK) || !size) {
+		uart_reply_reader(sender, tag, size ? -EAGAIN : 0);
+		return;
+	}
+
+	if ((err = uart_new_request(uart, &req, sender, tag,
+				    flags, size)) < 0) {
+		uart_reply_reader(sender, tag, err);
+		return;
+	}
+
+	if (flags & UART_TIMEOUT) {
+		req->deadline = uart_time_ms() + timeout_ms;
+		uart_timeout_arm(req->deadline);
+	}
+	list_insert_tail(&req->list, &uart->readers);
+
+	uart->rx_waiting = 1;
+	l4_smp_mb();
+	uart_serve_readers(uart);
+}
+
+/*
+ * Takes the ring page that came with the request, and gives the
+ * client the thread and slot to wake the console on. The console
+ * is woken to look at the new ring.
+ */
+void console_attach(l4id_t sender, unsigned int fpage)
+{
+	struct l4_channel_port *port;
+
+	if (!(port = l4_channel_accept(console_port, CONSOLE_CLIENTS_MAX,
+				       sender, fpage,
+				       sizeof(struct console_entry)))) {
+		uart_reply(sender, -EINVAL);
+		return;
+	}
+
+	console_partial[port - console_port] = 0;
+	l4_channel_publish(port);
+
+	write_mr(L4SYS_ARG0, tid_console);
+	write_mr(L4SYS_ARG1, CONSOLE_SLOT);
+	uart_reply(sender, 0);
+
+	l4_notify(tid_console, CONSOLE_SLOT);
+}
+
+void console_detach(l4id_t sender)
+{
+	struct l4_channel_port *port;
+
+	if (!(port = l4_channel_find(console_port, CONSOLE_CLIENTS_MAX,
+				     sender))) {
+		uart_reply(sender, -ENOENT);
+		return;
+	}
+
+	l4_mutex_lock(&console_lock);
+	l4_channel_release(port);
+	l4_mutex_unlock(&console_lock);
+
+	uart_reply(sender, 0);
+}
+
 int uart_setup_devices(void)
 {
+	struct l4_thread thread;
+	struct l4_thread *tptr = &thread;
 	int err;
 
 	uart[0].phys_base = PLATFORM_UART1_BASE;
+	uart[0].irq_no = IRQ_UART1;
 
 	for (int i = 0; i < UARTS_TOTAL; i++) {
 		/* Get one page from address pool */
 		uart[i].base = (unsigned long)l4_new_virtual(1);
+		uart[i].slot = 0;
+
+		uart_ring_init(&uart[i].tx, uart_tx_data[i], UART_TX_RING_SIZE);
+		uart_ring_init(&uart[i].rx, uart_rx_data[i], UART_RX_RING_SIZE);
+		l4_mutex_init(&uart[i].tx_lock);
+		link_init(&uart[i].writers);
+		link_init(&uart[i].readers);
 
 		/* Map uart to a virtual address region */
 		if (IS_ERR(err = l4_map((void *)uart[i].phys_base,
@@ -47,9 +673,48 @@ int uart_setup_devices(void)
 			BUG();
 		}
 
-		/* Initialize uart */
+		/* Initialize uart, with fifos as we serve it by irqs */
 		uart_init(uart[i].base);
+		uart_fifo_enable(uart[i].base);
+
+		/*
+		 * Create new uart irq handler thread.
+		 *
+		 * This will register itself as the irq handler,
+		 * enable rx irqs and wait on irqs.
+		 */
+		if ((err = thread_create(uart_irq_handler, &uart[i],
+					 TC_SHARE_SPACE,
+					 &tptr)) < 0) {
+			printf("FATAL: Creation of irq handler "
+			       "thread failed.\n");
+			BUG();
+		}
+	}
+
+	/* One timeout thread serves all uarts */
+	if ((err = thread_create(uart_timeout_handler, 0,
+				 TC_SHARE_SPACE, &tptr)) < 0) {
+		printf("FATAL: Creation of timeout "
+		       "thread failed.\n");
+		BUG();
+	}
+	tid_timeout = tptr->ids.tid;
+
+	/* Console thread, with windows for client rings */
+	for (int i = 0; i < CONSOLE_CLIENTS_MAX; i++) {
+		console_port[i].window = l4_new_virtual(1);
+		console_port[i].order = CONSOLE_RING_ORDER;
+	}
+
+	if ((err = thread_create(uart_console_handler, 0,
+				 TC_SHARE_SPACE, &tptr)) < 0) {
+		printf("FATAL: Creation of console "
+		       "thread failed.\n");
+		BUG();
 	}
+	tid_console = tptr->ids.tid;
+
 	return 0;
 }
 
@@ -79,10 +744,11 @@ void init_vaddr_pool(void)
 			/*
 			 * Do we have any unused virtual space
 			 * where we run, and do we have enough
-			 * pages of it to map all uarts?
+			 * pages of it to map all uarts, and
+			 * the rings of console clients?
 			 */
-			if (__pfn(page_align_up(__end))
-			    + UARTS_TOTAL <= caparray[i].end) {
+			if (__pfn(page_align_up(__end)) + UARTS_TOTAL +
+			    CONSOLE_CLIENTS_MAX <= caparray[i].end) {
 				/*
 				 * Yes. We initialize the device
 				 * virtual memory pool here.
@@ -112,25 +778,27 @@ void *l4_new_virtual(int npages)
 	return address_new(&device_vaddr_pool, npages, PAGE_SIZE);
 }
 
-void uart_generic_tx(char c, int devno)
-{
-	uart_tx_char(uart[devno].base, c);
-}
-
-char uart_generic_rx(int devno)
-{
-	return uart_rx_char(uart[devno].base);
-}
-
 void handle_requests(void)
 {
 	u32 mr[MR_UNUSED_TOTAL];
+	unsigned int fpage;
 	l4id_t senderid;
+	char c;
 	u32 tag;
 	int ret;
 
-	printf("%s: Initiating ipc.\n", __CONTAINER__);
-	if ((ret = l4_receive(L4_ANYTHREAD)) < 0) {
+	/*
+	 * Full receive, as sends carry their bytes in the utcb. A free
+	 * console port takes the ring page of an attach. With none free,
+	 * or a page the sender cannot pass on, the kernel refuses the
+	 * item, which fails our receive as well as the sender's ipc.
+	 */
+	if ((ret = l4_receive_full_map(L4_ANYTHREAD,
+				       l4_channel_window(console_port,
+							 CONSOLE_CLIENTS_MAX),
+				       &fpage)) < 0) {
+		if (ret == -ENOIPC || ret == -EFAULT)
+			return;
 		printf("%s: %s: IPC Error: %d. Quitting...\n",
 		       __CONTAINER__, __FUNCTION__, ret);
 		BUG();
@@ -162,23 +830,44 @@ void handle_requests(void)
 	  */
 	switch (tag) {
 	case L4_IPC_TAG_UART_SENDCHAR:
-		printf("got L4_IPC_TAG_UART_SENDCHAR with char %d\n ", mr[0]);
-		uart_generic_tx((char)mr[0], 0);
+		c = (char)mr[0];
+		uart_send(&uart[0], senderid, tag, &c, 1, 0);
 		break;
 	case L4_IPC_TAG_UART_RECVCHAR:
-		mr[0] = (int)uart_generic_rx(0);
+		uart_recv(&uart[0], senderid, tag, 1, 0, 0);
+		break;
+	case L4_IPC_TAG_UART_SENDBUF:
+		if (mr[0] > UART_SENDBUF_MAX)
+			mr[0] = UART_SENDBUF_MAX;
+		uart_send(&uart[0], senderid, tag,
+			  (char *)l4_get_utcb()->mr_rest, mr[0], mr[1]);
+		break;
+	case L4_IPC_TAG_UART_RECVBUF:
+		uart_recv(&uart[0], senderid, tag, mr[0], mr[1], mr[2]);
+		break;
+
+	/* Intra container ipc by irq and timeout threads */
+	case L4_IPC_TAG_UART_IRQ:
+		uart_serve_readers(&uart[0]);
+		uart_serve_writers(&uart[0]);
+		break;
+	case L4_IPC_TAG_UART_TIMEOUT:
+		uart_expire_readers(&uart[0]);
+		uart_reply(senderid, 0);
+		break;
+
+	case L4_IPC_TAG_CONSOLE_ATTACH:
+		console_attach(senderid, fpage);
+		break;
+	case L4_IPC_TAG_CONSOLE_DETACH:
+		console_detach(senderid);
 		break;
 	default:
 		printf("%s: Error received ipc from 0x%x residing "
 		       "in container %x with an unrecognized tag: "
 		       "0x%x\n", __CONTAINER__, senderid,
 		       __cid(senderid), tag);
-	}
-
-	/* Reply */
-	if ((ret = l4_ipc_return(ret)) < 0) {
-		printf("%s: IPC return error: %d.\n", __FUNCTION__, ret);
-		BUG();
+		uart_reply(senderid, -EINVAL);
 	}
 }
 
@@ -193,6 +882,9 @@ void main(void)
 	/* Initialize virtual address pool for uarts */
 	init_vaddr_pool();
 
+	/* Set the tid of ipc handler before its helpers start */
+	tid_ipc_handler = self_tid();
+
 	/* Map and initialize uart devices */
 	uart_setup_devices();
 
@@ -200,4 +892,3 @@ void main(void)
 	while (1)
 		handle_requests();
 }
-
@@ -1,17 +1,22 @@
-
 #include <sys/time.h>
 #include <errno.h>
+#include <l4lib/time.h>
 #include <libposix.h>
 
 int gettimeofday(struct timeval *tv, struct timezone *tz)
 {
-	int ret = l4_time(tv, 0);
+	u32 sec, usec;
 
-	/* If error, return positive error code */
-	if (ret < 0) {
-		errno = -ret;
+	if (!tv) {
+		errno = EFAULT;
 		return -1;
 	}
-	/* else return value */
-	return ret;
+
+	/* Read from time page, no need to trap */
+	l4_gettime(&sec, &usec);
+
+	tv->tv_sec = sec;
+	tv->tv_usec = usec;
+
+	return 0;
 }
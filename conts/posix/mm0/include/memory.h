@@ -38,6 +38,10 @@ void *pager_map_file_range(struct vm_file *f, unsigned long byte_offset,
 void *pager_validate_map_user_range2(struct tcb *user, void *userptr,
 				    unsigned long size, unsigned int vm_flags);
 
+/* Pre-cleared pages, refilled while the pager is idle */
+struct page *alloc_zeroed_page(void);
+void zero_pool_refill(void);
+
 void *l4_new_virtual(int npages);
 void *l4_del_virtual(void *virt, int npages);
 
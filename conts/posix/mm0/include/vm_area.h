@@ -231,6 +231,7 @@ struct vm_obj_link *vma_next_link(struct link *link,
 struct vm_object *vm_object_create(void);
 struct vm_file *vm_file_create(void);
 int vm_file_delete(struct vm_file *f);
+int vm_object_is_deletable(struct vm_object *obj);
 int vm_object_delete(struct vm_object *vmo);
 void vm_file_put(struct vm_file *f);
 
@@ -24,6 +24,7 @@
 #include <test.h>
 #include <capability.h>
 #include <globals.h>
+#include <memory.h>
 
 /* Receives all registers and origies back */
 int ipc_test_full_sync(l4id_t senderid)
@@ -219,6 +220,9 @@ void main(void)
 	printf("%s: Memory/Process manager initialized. Listening requests.\n", __TASKNAME__);
 	while (1) {
 		handle_requests();
+
+		/* Clear pages for later faults before blocking again */
+		zero_pool_refill();
 	}
 }
 
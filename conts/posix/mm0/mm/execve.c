@@ -36,6 +36,42 @@ int task_setup_from_executable(struct vm_file *vmfile,
 	return elf_parse_executable(task, vmfile, efd);
 }
 
+/*
+ * Executables started lately, held open by the pager so that
+ * their page cache outlives the tasks running them. sys_open()
+ * finds a vm_file by its vnode, so every task of the same path
+ * maps the very same text and read-only data pages, whether it
+ * starts alongside other instances or after they have exited.
+ */
+#define EXEC_CACHE_FILES	8
+
+static struct vm_file *exec_cache[EXEC_CACHE_FILES];
+
+/* Marks vmfile most recently used, dropping the least if cache is full */
+static void exec_cache_hold(struct vm_file *vmfile)
+{
+	struct vm_file *evicted = 0;
+	int i;
+
+	for (i = 0; i < EXEC_CACHE_FILES - 1; i++)
+		if (exec_cache[i] == vmfile)
+			break;
+
+	/* Not cached, it takes an opener reference of its own */
+	if (exec_cache[i] != vmfile) {
+		evicted = exec_cache[i];
+		vmfile->openers++;
+	}
+
+	memmove(&exec_cache[1], &exec_cache[0], i * sizeof(exec_cache[0]));
+	exec_cache[0] = vmfile;
+
+	/* Without openers, the last task to unmap it deletes the file */
+	if (evicted && --evicted->openers == 0 &&
+	    vm_object_is_deletable(&evicted->vm_obj))
+		vm_file_delete(evicted);
+}
+
 int init_execve(char *filepath)
 {
 	struct vm_file *vmfile;
@@ -105,6 +141,10 @@ int init_execve(char *filepath)
 		return err;
 	}
 
+	/* Text pages stay cached, the pager's own descriptor is not needed */
+	exec_cache_hold(vmfile);
+	sys_close(self, fd);
+
 	/* Set up task registers via exchange_registers() */
 	task_setup_registers(new_task, 0,
 			     new_task->args_start,
@@ -216,6 +256,10 @@ int do_execve(struct tcb *sender, char *filename,
 		return err;
 	}
 
+	/* Text pages stay cached, the pager's own descriptor is not needed */
+	exec_cache_hold(vmfile);
+	sys_close(self, fd);
+
 	/* Set up task registers via exchange_registers() */
 	task_setup_registers(new_task, 0,
 			     new_task->args_start,
@@ -115,11 +115,15 @@ int vm_object_is_subset(struct vm_object *shadow,
 	return 1;
 }
 
+/*
+ * A shadow under another can be dropped from a vma once every one
+ * of its pages has been copied up, i.e. it is hidden entirely.
+ */
 static inline int vm_object_is_droppable(struct vm_object *shadow,
 					 struct vm_object *original)
 {
-	if (shadow->npages == original->npages &&
-	    (original->flags & VM_OBJ_SHADOW))
+	if ((original->flags & VM_OBJ_SHADOW) &&
+	    vm_object_is_subset(shadow, original))
 		return 1;
 	else
 		return 0;
@@ -243,15 +247,25 @@ struct vm_obj_link *vma_create_shadow(void)
 	return vmo_link;
 }
 
-/* Allocates a new page, copies the original onto it and returns. */
+/*
+ * Allocates a new page, copies the original onto it and returns.
+ * A copy of the zero page is served ready-made from the zeroed pool.
+ */
 struct page *copy_to_new_page(struct page *orig)
 {
-	void *paddr = alloc_page(1);
+	void *paddr;
+	struct page *new;
 
-	BUG_ON(!paddr);
+	if (orig->owner && (orig->owner->flags & VM_OBJ_FILE) &&
+	    vm_object_to_file(orig->owner)->type == VM_FILE_DEVZERO) {
+		BUG_ON(!(new = alloc_zeroed_page()));
+		return new;
+	}
+
+	BUG_ON(!(paddr = alloc_page(1)));
 
 	/* Copy the page into new page */
-	memcpy(phys_to_virt(paddr), page_to_virt(orig), PAGE_SIZE);
+	copy_page(phys_to_virt(paddr), page_to_virt(orig));
 
 	return phys_to_page(paddr);
 }
@@ -469,6 +483,75 @@ int vma_drop_merge_delete_all(struct vm_area *vma)
 	return 0;
 }
 
+/*
+ * Shadows a private vma may have under its writable one. Every fork
+ * adds one, and lookups walk each of them before reaching the file.
+ */
+#define VMA_SHADOW_DEPTH_MAX		4
+
+/* Counts the read-only shadows under the first object of a vma */
+static int vma_shadow_depth(struct vm_area *vma)
+{
+	struct vm_obj_link *vmo_link;
+	int depth = 0;
+
+	vmo_link = link_to_struct(vma->vm_obj_list.next,
+				  struct vm_obj_link, list);
+	while ((vmo_link = vma_next_link(&vmo_link->list, &vma->vm_obj_list)) &&
+	       (vmo_link->obj->flags & VM_OBJ_SHADOW))
+		depth++;
+
+	return depth;
+}
+
+/*
+ * Collapses the shadow chain of a private vma into its writable top
+ * shadow. Pages that the vma sees through the read-only shadows are
+ * copied up and mapped read-only in place of the originals, then the
+ * shadows are dropped from this vma. Other vmas sharing the shadows
+ * keep them, and a shadow left with a single mapper is merged as usual.
+ */
+static void vma_collapse_shadows(struct tcb *task, struct vm_area *vma,
+				 struct vm_obj_link *top_link)
+{
+	struct vm_object *top = top_link->obj;
+	unsigned long npages = vma->pfn_end - vma->pfn_start;
+	struct vm_obj_link *vmo_link;
+	struct page *p, *new_page;
+
+	BUG_ON(!(top->flags & VM_WRITE));
+
+	while ((vmo_link = vma_next_link(&top_link->list, &vma->vm_obj_list)) &&
+	       (vmo_link->obj->flags & VM_OBJ_SHADOW)) {
+		list_foreach_struct(p, &vmo_link->obj->page_cache, list) {
+			/* Outside the vma, or already hidden by a nearer copy */
+			if (p->offset < vma->file_offset ||
+			    p->offset >= vma->file_offset + npages ||
+			    find_page(top, p->offset))
+				continue;
+
+			new_page = copy_to_new_page(p);
+
+			spin_lock(&new_page->lock);
+			BUG_ON(!list_empty(&new_page->list));
+			new_page->refcnt = 0;
+			new_page->owner = top;
+			new_page->offset = p->offset;
+			new_page->virtual = 0;
+			spin_unlock(&new_page->lock);
+
+			insert_page_olist(new_page, top);
+			top->npages++;
+
+			/* Stop the task using the page about to be unlinked */
+			l4_map((void *)page_to_phys(new_page),
+			       (void *)vma_page_to_virtual(vma, new_page), 1,
+			       MAP_USR_RO, task->tid);
+		}
+		vma_drop_merge_delete(vma, vmo_link);
+	}
+}
+
 /* TODO:
  * - Why not allocate a swap descriptor in vma_create_shadow() rather than
  *   a bare vm_object? It will be needed.
@@ -497,6 +580,16 @@ struct page *copy_on_write(struct fault_data *fault)
 		BUG();
 	}
 
+	/*
+	 * A read-only shadow that no other vma or shadow refers to,
+	 * e.g. one left by a forked child that has since exited, is
+	 * made writable again rather than stacking a new one over it.
+	 */
+	if ((vmo_link->obj->flags & VM_OBJ_SHADOW) &&
+	    !(vmo_link->obj->flags & VM_WRITE) &&
+	    vmo_link->obj->nlinks == 1 && vmo_link->obj->shadows == 0)
+		vmo_link->obj->flags |= VM_WRITE;
+
 	/* Is the object read-only? Create a shadow object if so.
 	 *
 	 * NOTE: Whenever the topmost object is read-only, a new shadow
@@ -614,6 +707,10 @@ struct page *copy_on_write(struct fault_data *fault)
 		}
 		if (vm_object_is_droppable(shadow_link->obj, vmo_link->obj))
 			vma_drop_merge_delete(vma, vmo_link);
+
+		/* Keep lookups short however deep the fork tree grows */
+		if (vma_shadow_depth(vma) > VMA_SHADOW_DEPTH_MAX)
+			vma_collapse_shadows(fault->task, vma, shadow_link);
 	}
 
 	return new_page;
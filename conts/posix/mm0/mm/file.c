@@ -29,6 +29,7 @@
 #include <alloca.h>
 #include <path.h>
 #include <syscalls.h>
+#include <memory.h>
 
 #include INC_GLUE(message.h)
 
@@ -472,21 +473,26 @@ int sys_fsync(struct tcb *task, int fd)
 	return fsync_common(task, fd);
 }
 
-/* FIXME: Add error handling to this */
-/* Extends a file's size by adding it new pages */
+/*
+ * Extends a file's size by adding it new pages. The pages are
+ * cleared, so that the new part of the file reads as zeroes.
+ */
 int new_file_pages(struct vm_file *f, unsigned long start, unsigned long end)
 {
 	unsigned long npages = end - start;
 	struct page *page;
-	void *paddr;
-
-	/* Allocate the memory for new pages */
-	if (!(paddr = alloc_page(npages)))
-		return -ENOMEM;
 
 	/* Process each page */
 	for (unsigned long i = 0; i < npages; i++) {
-		page = phys_to_page(paddr + PAGE_SIZE * i);
+		if (!(page = alloc_zeroed_page())) {
+			/* Give back the pages added so far */
+			while (i--) {
+				page = find_page(&f->vm_obj, start + i);
+				list_remove_init(&page->list);
+				free_page((void *)page_to_phys(page));
+			}
+			return -ENOMEM;
+		}
 		page_init(page);
 		page->refcnt++;
 		page->owner = &f->vm_obj;
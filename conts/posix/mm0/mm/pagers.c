@@ -362,7 +362,7 @@ int init_devzero(void)
 	zphys = alloc_page(1);
 	zpage = phys_to_page(zphys);
 	zvirt = (void *)phys_to_virt(zphys);
-	memset(zvirt, 0, PAGE_SIZE);
+	clear_page(zvirt);
 
 	/*
 	 * FIXME:
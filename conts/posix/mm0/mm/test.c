@@ -49,6 +49,20 @@ int vm_object_test_shadow_count(struct vm_object *vmo)
 	return 0;
 }
 
+/*
+ * A vnode must have a single vm_file, or tasks of the
+ * same file would each end up with their own page cache.
+ */
+int vm_file_test_vnode_unique(struct vm_file *f)
+{
+	struct vm_file *other;
+
+	list_foreach_struct(other, &global_vm_files.list, list)
+		BUG_ON(other != f && other->type == VM_FILE_VFS &&
+		       other->vnode == f->vnode);
+	return 0;
+}
+
 /* TODO:
  * Add checking that total open file descriptors are
  * equal to total opener count of all files
@@ -81,8 +95,10 @@ int mm0_test_global_vm_integrity(void)
 		vmstat.vm_files++;
 		if (f->type == VM_FILE_SHM)
 			vmstat.shm_files++;
-		else if (f->type == VM_FILE_VFS)
+		else if (f->type == VM_FILE_VFS) {
 			vmstat.vfs_files++;
+			vm_file_test_vnode_unique(f);
+		}
 		else if (f->type == VM_FILE_DEVZERO)
 			vmstat.devzero++;
 		else BUG();
@@ -0,0 +1,80 @@
+/*
+ * Pool of pre-cleared physical pages.
+ *
+ * Anonymous write faults and file extensions need zeroed pages.
+ * Rather than clearing them while the faulting task waits, the
+ * pager clears a few pages at a time after it has replied to a
+ * request, and the fault paths take from here first.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4/macros.h>
+#include <l4/config.h>
+#include <l4/types.h>
+#include <l4/lib/list.h>
+#include L4LIB_INC_ARCH(syscalls.h)
+#include L4LIB_INC_ARCH(syslib.h)
+#include INC_GLUE(memory.h)
+#include <mem/alloc_page.h>
+#include <vm_area.h>
+#include <memory.h>
+
+/* Pages kept cleared ahead of demand */
+#define ZERO_POOL_PAGES		64
+
+/* Pages cleared per idle pass, so the next request is not held up long */
+#define ZERO_POOL_BATCH		4
+
+/*
+ * Free pages below which the pool neither grows nor keeps its
+ * pages, so that plain alloc_page() callers get them instead.
+ */
+#define ZERO_POOL_RESERVE	256
+
+static struct zero_pool {
+	int npages;
+	void *paddr[ZERO_POOL_PAGES];
+} zero_pool;
+
+/*
+ * Returns a cleared page, from the pool if one is ready,
+ * else allocated and cleared on the spot.
+ */
+struct page *alloc_zeroed_page(void)
+{
+	void *paddr;
+
+	if (zero_pool.npages)
+		return phys_to_page(zero_pool.paddr[--zero_pool.npages]);
+
+	if (!(paddr = alloc_page(1)))
+		return 0;
+
+	clear_page(phys_to_virt(paddr));
+
+	return phys_to_page(paddr);
+}
+
+/*
+ * Tops up the pool by a bounded batch. Called when the pager
+ * has no request in hand, i.e. off any task's fault path.
+ * When free memory runs low, pooled pages are given back
+ * instead, until free memory is back above the reserve.
+ */
+void zero_pool_refill(void)
+{
+	void *paddr;
+
+	while (zero_pool.npages &&
+	       free_page_count() < ZERO_POOL_RESERVE)
+		BUG_ON(free_page(zero_pool.paddr[--zero_pool.npages]) < 0);
+
+	for (int i = 0; i < ZERO_POOL_BATCH &&
+	     zero_pool.npages < ZERO_POOL_PAGES &&
+	     free_page_count() > ZERO_POOL_RESERVE; i++) {
+		if (!(paddr = alloc_page(1)))
+			return;
+		clear_page(phys_to_virt(paddr));
+		zero_pool.paddr[zero_pool.npages++] = paddr;
+	}
+}
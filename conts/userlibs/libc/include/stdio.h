@@ -152,6 +152,9 @@ extern FILE *stderr;
 extern FILE *stdin;
 extern FILE *stdout;
 
+/* Console that stdout and stderr go to, if not the uart */
+extern size_t (*__console_write)(const char *, size_t);
+
 /* 7.19.4 Operations on files */
 int remove(const char *);
 int rename(const char *, const char *);
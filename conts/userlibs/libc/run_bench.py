@@ -0,0 +1,69 @@
+#!/usr/bin/python
+#
+# Builds tests/bench_string.c with the arch-arm string routines and
+# the generic C ones, as a static linux binary for the configured
+# cpu, and runs it under qemu-arm. Needs a configured tree, and a
+# linux targeted toolchain (e.g. arm-none-linux-gnueabi-).
+#
+# Usage: run_bench.py [-c] [toolchain-prefix]
+#	-c	Only run the correctness checks
+#
+import os
+import sys
+from os.path import join
+
+PROJRELROOT = '../../..'
+sys.path.append(PROJRELROOT)
+
+from scripts.config.projpaths import *
+from scripts.config.configuration import *
+
+routines = ['memcpy', 'memmove', 'memset', 'memcmp']
+builddir = join(BUILDDIR, LIBC_RELDIR, 'bench')
+
+def run(cmd):
+	print(cmd)
+	if os.system(cmd) != 0:
+		print("Error: %s has failed." % cmd)
+		sys.exit(1)
+
+def rename(prefix):
+	return " ".join(["-D%s=%s_%s" % (r, prefix, r) for r in routines])
+
+def main():
+	args = sys.argv[1:]
+	checks_only = "-c" in args
+	args = [a for a in args if a != "-c"]
+
+	config = configuration_retrieve()
+	cc = (args and args[0] or config.toolchain_userspace) + "gcc"
+	cflags = "-O2 -std=gnu99 -Wall -Werror -march=" + config.gcc_arch_flag
+
+	if not os.path.exists(builddir):
+		os.makedirs(builddir)
+
+	objs = []
+	for src in ["memcpy.S", "memset.S", "memcmp.S"]:
+		obj = join(builddir, "arch_" + src.replace(".S", ".o"))
+		run("%s %s -D__ASSEMBLY__ -I%s -include l4/macros.h %s -c %s -o %s" %
+		    (cc, cflags, KERNEL_HEADERS, rename("arch"),
+		     join("src/arch-arm", src), obj))
+		objs.append(obj)
+
+	# Generic versions build against our own headers, as in libc
+	for src in ["memcpy.c", "memset.c", "memcmp.c"]:
+		obj = join(builddir, "generic_" + src.replace(".c", ".o"))
+		run("%s %s -ffreestanding -nostdinc -Iinclude "
+		    "-Iinclude/sys-userspace/arch-arm -include stddef.h "
+		    "%s -c %s -o %s" %
+		    (cc, cflags, rename("generic"), join("src", src), obj))
+		objs.append(obj)
+
+	bench = join(builddir, "bench_string")
+	run("%s %s -static tests/bench_string.c %s -o %s" %
+	    (cc, cflags, " ".join(objs), bench))
+
+	run("qemu-arm %s%s" % (bench, checks_only and " -c" or ""))
+
+if __name__ == "__main__":
+	main()
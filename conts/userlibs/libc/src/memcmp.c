@@ -83,6 +83,7 @@
 
 /* THREAD SAFE */
 int
+__attribute__ ((weak))
 memcmp(const void *s1, const void *s2, size_t n)
 {
 	size_t          i;
@@ -3,6 +3,13 @@
 
 extern int __fputc(int c, FILE *stream);
 
+/*
+ * Takes stdout and stderr off the uart once a console client,
+ * e.g. l4_console_attach() of libl4, installs itself here. It is
+ * given bytes as they are written and must consume all of them.
+ */
+size_t (*__console_write)(const char *buf, size_t count);
+
 static int ser_out(int c)
 {
 	__fputc(c, 0);
@@ -16,8 +23,15 @@ l4kdb_write(void *data, long int position, size_t count, void *handle /*unused*/
 {
 	size_t i;
 	char *real_data = data;
+
+	if (__console_write)
+		return __console_write(real_data, count);
+
+	/* Without the uart mapped to tasks, output is lost */
+#if defined(CONFIG_USERSPACE_CONSOLE)
 	for (i = 0; i < count; i++)
 		ser_out(real_data[i]);
+#endif
 	return count;
 }
 
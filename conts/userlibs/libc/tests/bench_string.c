@@ -0,0 +1,253 @@
+/*
+ * Checks and times the libc string routines against the generic
+ * C versions. Built by run_bench.py as a static linux binary for
+ * the target, and run under qemu-arm or on a board.
+ *
+ * The routines under test are renamed at build time, so that
+ * they do not clash with the host C library:
+ *
+ *	memcpy -> arch_memcpy, or generic_memcpy for src/memcpy.c
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+void *arch_memcpy(void *dst, const void *src, size_t len);
+void *arch_memmove(void *dst, const void *src, size_t len);
+void *arch_memset(void *dst, int c, size_t len);
+int arch_memcmp(const void *s1, const void *s2, size_t len);
+void *generic_memcpy(void *dst, const void *src, size_t len);
+void *generic_memset(void *dst, int c, size_t len);
+int generic_memcmp(const void *s1, const void *s2, size_t len);
+
+/*
+ * Sizes seen in our traffic: small structures, console lines,
+ * utcb buffers, file blocks and pages, and a large buffer.
+ */
+static const size_t sizes[] = { 8, 32, 80, 256, 1024, 4096, 65536 };
+
+/* Destination and source offsets from a word boundary */
+static const int aligns[][2] = {
+	{ 0, 0 }, { 0, 1 }, { 0, 2 }, { 0, 3 }, { 1, 0 }, { 3, 1 },
+};
+
+#define NSIZES		(sizeof(sizes) / sizeof(sizes[0]))
+#define NALIGNS		(sizeof(aligns) / sizeof(aligns[0]))
+#define BUF_SIZE	(65536 + 64)
+#define GUARD		0xA5
+#define BENCH_BYTES	(16 * 1024 * 1024)
+
+static unsigned char bufa[BUF_SIZE] __attribute__((aligned(64)));
+static unsigned char bufb[BUF_SIZE] __attribute__((aligned(64)));
+static unsigned char ref[BUF_SIZE] __attribute__((aligned(64)));
+
+static int failures;
+
+static void fill(unsigned char *buf, size_t len, unsigned int seed)
+{
+	for (size_t i = 0; i < len; i++)
+		buf[i] = (unsigned char)(seed + i * 7);
+}
+
+static void check(const char *name, unsigned char *buf, size_t len,
+		  int dalign, int salign, size_t size)
+{
+	if (!memcmp(buf, ref, len))
+		return;
+
+	for (size_t i = 0; i < len; i++) {
+		if (buf[i] != ref[i]) {
+			printf("FAIL %s size %lu dst+%d src+%d: "
+			       "byte %lu is 0x%x, not 0x%x\n", name,
+			       (unsigned long)size, dalign, salign,
+			       (unsigned long)i, buf[i], ref[i]);
+			break;
+		}
+	}
+	failures++;
+}
+
+/* Every length up to a few bursts, at every alignment */
+static void test_copies(void)
+{
+	for (size_t len = 0; len < 200; len++) {
+		for (int d = 0; d < 4; d++) {
+			for (int s = 0; s < 4; s++) {
+				fill(bufa, 256, len);
+				memset(bufb, GUARD, 256);
+				memcpy(ref, bufb, 256);
+				memcpy(ref + 8 + d, bufa + 8 + s, len);
+				arch_memcpy(bufb + 8 + d, bufa + 8 + s, len);
+				check("memcpy", bufb, 256, d, s, len);
+
+				/* Overlapping, both ways */
+				fill(bufb, 256, len);
+				memcpy(ref, bufb, 256);
+				memmove(ref + 8 + d, ref + 8 + s + 4, len);
+				arch_memmove(bufb + 8 + d, bufb + 8 + s + 4, len);
+				check("memmove down", bufb, 256, d, s + 4, len);
+
+				fill(bufb, 256, len);
+				memcpy(ref, bufb, 256);
+				memmove(ref + 8 + d + 4, ref + 8 + s, len);
+				arch_memmove(bufb + 8 + d + 4, bufb + 8 + s, len);
+				check("memmove up", bufb, 256, d + 4, s, len);
+			}
+
+			memset(bufb, GUARD, 256);
+			memcpy(ref, bufb, 256);
+			memset(ref + 8 + d, 0x3C, len);
+			arch_memset(bufb + 8 + d, 0x13C, len);
+			check("memset", bufb, 256, d, 0, len);
+		}
+	}
+}
+
+static int sign(int val)
+{
+	return (val > 0) - (val < 0);
+}
+
+static void test_compares(void)
+{
+	for (size_t len = 1; len < 64; len++) {
+		for (int d = 0; d < 4; d++) {
+			for (int s = 0; s < 4; s++) {
+				fill(bufa + d, len, 0);
+				fill(bufb + s, len, 0);
+				if (arch_memcmp(bufa + d, bufb + s, len)) {
+					printf("FAIL memcmp size %lu +%d +%d: "
+					       "equal buffers differ\n",
+					       (unsigned long)len, d, s);
+					failures++;
+				}
+
+				/* Both orders, at each position */
+				for (size_t i = 0; i < len; i++) {
+					bufb[s + i] ^= 0x80;
+					if (sign(arch_memcmp(bufa + d, bufb + s,
+							     len)) !=
+					    sign(memcmp(bufa + d, bufb + s,
+							len))) {
+						printf("FAIL memcmp size %lu "
+						       "+%d +%d: byte %lu\n",
+						       (unsigned long)len,
+						       d, s, (unsigned long)i);
+						failures++;
+					}
+					bufb[s + i] ^= 0x80;
+				}
+			}
+		}
+	}
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Returns MB/s of copying size bytes over and over */
+static double time_copy(void *(*copy)(void *, const void *, size_t),
+			size_t size, int dalign, int salign)
+{
+	size_t rounds = BENCH_BYTES / size;
+	double start = now();
+
+	for (size_t i = 0; i < rounds; i++)
+		copy(bufb + dalign, bufa + salign, size);
+
+	return rounds * size / (now() - start) / (1024 * 1024);
+}
+
+static double time_set(void *(*set)(void *, int, size_t),
+		       size_t size, int dalign)
+{
+	size_t rounds = BENCH_BYTES / size;
+	double start = now();
+
+	for (size_t i = 0; i < rounds; i++)
+		set(bufb + dalign, (int)i, size);
+
+	return rounds * size / (now() - start) / (1024 * 1024);
+}
+
+static double time_compare(int (*cmp)(const void *, const void *, size_t),
+			   size_t size, int dalign, int salign)
+{
+	size_t rounds = BENCH_BYTES / size;
+	double start = now();
+	volatile int res;
+
+	for (size_t i = 0; i < rounds; i++)
+		res = cmp(bufb + dalign, bufa + salign, size);
+	(void)res;
+
+	return rounds * size / (now() - start) / (1024 * 1024);
+}
+
+static void bench(void)
+{
+	fill(bufa, BUF_SIZE, 0);
+	memcpy(bufb, bufa, BUF_SIZE);
+
+	printf("\n%-8s %6s %8s %10s %10s %7s\n", "routine", "size",
+	       "dst/src", "arch MB/s", "C MB/s", "speedup");
+
+	for (size_t i = 0; i < NSIZES; i++) {
+		for (size_t j = 0; j < NALIGNS; j++) {
+			int d = aligns[j][0], s = aligns[j][1];
+			double a = time_copy(arch_memcpy, sizes[i], d, s);
+			double c = time_copy(generic_memcpy, sizes[i], d, s);
+
+			printf("%-8s %6lu %6d/%d %10.1f %10.1f %6.2fx\n",
+			       "memcpy", (unsigned long)sizes[i], d, s,
+			       a, c, a / c);
+		}
+	}
+
+	for (size_t i = 0; i < NSIZES; i++) {
+		for (int d = 0; d < 2; d++) {
+			double a = time_set(arch_memset, sizes[i], d);
+			double c = time_set(generic_memset, sizes[i], d);
+
+			printf("%-8s %6lu %6d/- %10.1f %10.1f %6.2fx\n",
+			       "memset", (unsigned long)sizes[i], d,
+			       a, c, a / c);
+		}
+	}
+
+	/* Equal buffers, so that all bytes are compared */
+	for (size_t i = 0; i < NSIZES; i++) {
+		double a = time_compare(arch_memcmp, sizes[i], 0, 0);
+		double c = time_compare(generic_memcmp, sizes[i], 0, 0);
+
+		printf("%-8s %6lu %6d/%d %10.1f %10.1f %6.2fx\n",
+		       "memcmp", (unsigned long)sizes[i], 0, 0,
+		       a, c, a / c);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	test_copies();
+	test_compares();
+
+	if (failures) {
+		printf("%d checks failed.\n", failures);
+		return 1;
+	}
+	printf("All checks passed.\n");
+
+	if (argc > 1 && !strcmp(argv[1], "-c"))
+		return 0;
+
+	bench();
+	return 0;
+}
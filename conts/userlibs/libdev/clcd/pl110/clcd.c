@@ -1,3 +1,110 @@
+/*
+ * PL110/PL111 Colour LCD controller driver
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <dev/clcd.h>
+#include <dev/io.h>
+#include "clcd.h"
 
+const struct clcd_mode clcd_mode_vga = {
+	.width = 640,
+	.height = 480,
+	.hfp = 24,
+	.hsync = 96,
+	.hbp = 40,
+	.vfp = 11,
+	.vsync = 2,
+	.vbp = 32,
+};
 
+/* Converts generic irq bits to controller ones */
+static unsigned int pl110_irqs(unsigned int irqs)
+{
+	unsigned int val = 0;
 
+	if (irqs & CLCD_IRQ_FLIP)
+		val |= PL110_IRQ_LNBU;
+	if (irqs & CLCD_IRQ_VSYNC)
+		val |= PL110_IRQ_VCOMP;
+
+	return val;
+}
+
+/*
+ * Programs the timings, points the controller at fb_phys and
+ * turns on the panel, with all interrupts masked. The pixel
+ * clock is the board's clcd oscillator, undivided.
+ */
+void clcd_init(unsigned long base, const struct clcd_mode *mode,
+	       unsigned long fb_phys)
+{
+	clcd_disable(base);
+
+	write(PL110_TIM0_PPL(mode->width) | PL110_TIM0_HSW(mode->hsync) |
+	      PL110_TIM0_HFP(mode->hfp) | PL110_TIM0_HBP(mode->hbp),
+	      base + PL110_TIM0);
+	write(PL110_TIM1_LPL(mode->height) | PL110_TIM1_VSW(mode->vsync) |
+	      PL110_TIM1_VFP(mode->vfp) | PL110_TIM1_VBP(mode->vbp),
+	      base + PL110_TIM1);
+	write(PL110_TIM2_CPL(mode->width) | PL110_TIM2_IVS |
+	      PL110_TIM2_IHS | PL110_TIM2_BCD, base + PL110_TIM2);
+	write(0, base + PL110_TIM3);
+
+	write(fb_phys, base + PL110_UPBASE);
+	write(0, base + PL110_LPBASE);
+
+	write(0, base + PL110_IMSC);
+	write(PL110_IRQ_FUF | PL110_IRQ_LNBU | PL110_IRQ_VCOMP |
+	      PL110_IRQ_MBERR, base + PL110_ICR);
+
+	/* Enable first, and power up once signals are stable */
+	write(PL110_CNTL_EN | PL110_CNTL_BPP16 | PL110_CNTL_TFT |
+	      PL110_CNTL_VCOMP_VS, base + PL110_CNTL);
+	write(read(base + PL110_CNTL) | PL110_CNTL_PWR, base + PL110_CNTL);
+}
+
+void clcd_disable(unsigned long base)
+{
+	unsigned int val = read(base + PL110_CNTL);
+
+	write(val & ~PL110_CNTL_PWR, base + PL110_CNTL);
+	write(val & ~(PL110_CNTL_PWR | PL110_CNTL_EN), base + PL110_CNTL);
+}
+
+/*
+ * Takes effect at the next vertical sync. A flip irq left over
+ * from an earlier frame is cleared, so the next one is ours.
+ */
+void clcd_set_base(unsigned long base, unsigned long fb_phys)
+{
+	write(PL110_IRQ_LNBU, base + PL110_ICR);
+	write(fb_phys, base + PL110_UPBASE);
+}
+
+void clcd_irq_enable(unsigned long base, unsigned int irqs)
+{
+	write(read(base + PL110_IMSC) | pl110_irqs(irqs), base + PL110_IMSC);
+}
+
+void clcd_irq_disable(unsigned long base, unsigned int irqs)
+{
+	write(read(base + PL110_IMSC) & ~pl110_irqs(irqs),
+	      base + PL110_IMSC);
+}
+
+/* Returns pending enabled irqs, and clears them */
+unsigned int clcd_irq_status(unsigned long base)
+{
+	unsigned int mis = read(base + PL110_MIS);
+	unsigned int irqs = 0;
+
+	write(mis, base + PL110_ICR);
+
+	if (mis & PL110_IRQ_LNBU)
+		irqs |= CLCD_IRQ_FLIP;
+	if (mis & PL110_IRQ_VCOMP)
+		irqs |= CLCD_IRQ_VSYNC;
+
+	return irqs;
+}
@@ -1,5 +1,56 @@
-
+/*
+ * PL110/PL111 Colour LCD controller driver
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
 #ifndef __CLCD_H__
 #define __CLCD_H__
 
+/*
+ * Register offsets. The PL110 of versatile boards has control
+ * and interrupt mask the way round the PL111 of realview boards
+ * has them, so one layout serves all supported platforms.
+ */
+#define PL110_TIM0		0x00
+#define PL110_TIM1		0x04
+#define PL110_TIM2		0x08
+#define PL110_TIM3		0x0C
+#define PL110_UPBASE		0x10
+#define PL110_LPBASE		0x14
+#define PL110_CNTL		0x18
+#define PL110_IMSC		0x1C
+#define PL110_RIS		0x20
+#define PL110_MIS		0x24
+#define PL110_ICR		0x28
+#define PL110_UPCURR		0x2C
+
+/* Timing register fields */
+#define PL110_TIM0_PPL(ppl)	((((ppl) / 16) - 1) << 2)
+#define PL110_TIM0_HSW(hsw)	(((hsw) - 1) << 8)
+#define PL110_TIM0_HFP(hfp)	(((hfp) - 1) << 16)
+#define PL110_TIM0_HBP(hbp)	(((hbp) - 1) << 24)
+
+#define PL110_TIM1_LPL(lpl)	((lpl) - 1)
+#define PL110_TIM1_VSW(vsw)	(((vsw) - 1) << 10)
+#define PL110_TIM1_VFP(vfp)	((vfp) << 16)
+#define PL110_TIM1_VBP(vbp)	((vbp) << 24)
+
+#define PL110_TIM2_IVS		(1 << 11)	/* Active low vsync */
+#define PL110_TIM2_IHS		(1 << 12)	/* Active low hsync */
+#define PL110_TIM2_CPL(cpl)	(((cpl) - 1) << 16)
+#define PL110_TIM2_BCD		(1 << 26)	/* Pixel clock undivided */
+
+/* Control register bits */
+#define PL110_CNTL_EN		(1 << 0)
+#define PL110_CNTL_BPP16	(4 << 1)
+#define PL110_CNTL_TFT		(1 << 5)
+#define PL110_CNTL_PWR		(1 << 11)
+#define PL110_CNTL_VCOMP_VS	(0 << 12)	/* VComp at start of vsync */
+
+/* Interrupt bits */
+#define PL110_IRQ_FUF		(1 << 1)	/* Fifo underflow */
+#define PL110_IRQ_LNBU		(1 << 2)	/* Next base address taken */
+#define PL110_IRQ_VCOMP		(1 << 3)	/* Vertical compare */
+#define PL110_IRQ_MBERR		(1 << 4)	/* Bus error */
+
 #endif /* __CLCD_H__ */
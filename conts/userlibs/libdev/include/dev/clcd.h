@@ -0,0 +1,48 @@
+/*
+ * Generic colour lcd controller API
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __LIBDEV_CLCD_H__
+#define __LIBDEV_CLCD_H__
+
+/*
+ * Display timings. Widths are in pixels and must be
+ * a multiple of 16, heights are in lines.
+ */
+struct clcd_mode {
+	unsigned int width;
+	unsigned int height;
+	unsigned int hfp;	/* Front porch, sync and back porch */
+	unsigned int hsync;
+	unsigned int hbp;
+	unsigned int vfp;
+	unsigned int vsync;
+	unsigned int vbp;
+};
+
+/* 640x480 at 60Hz, which all supported boards and qemu take */
+extern const struct clcd_mode clcd_mode_vga;
+
+/* Framebuffers are 16 bits per pixel, rows packed */
+#define CLCD_BPP		16
+#define clcd_stride(mode)	((mode)->width * CLCD_BPP / 8)
+#define clcd_size(mode)		(clcd_stride(mode) * (mode)->height)
+
+/*
+ * A new framebuffer base is taken by the controller at the next
+ * vertical sync, and CLCD_IRQ_FLIP tells it has been taken, so
+ * the buffer that was shown until then is free.
+ */
+#define CLCD_IRQ_FLIP		(1 << 0)
+#define CLCD_IRQ_VSYNC		(1 << 1)	/* Start of vertical sync */
+
+void clcd_init(unsigned long base, const struct clcd_mode *mode,
+	       unsigned long fb_phys);
+void clcd_disable(unsigned long base);
+void clcd_set_base(unsigned long base, unsigned long fb_phys);
+void clcd_irq_enable(unsigned long base, unsigned int irqs);
+void clcd_irq_disable(unsigned long base, unsigned int irqs);
+unsigned int clcd_irq_status(unsigned long base);
+
+#endif /* __LIBDEV_CLCD_H__ */
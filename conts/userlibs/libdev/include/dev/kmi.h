@@ -14,6 +14,7 @@ struct keyboard_state{
 /* Common functions */
 void kmi_rx_irq_enable(unsigned long base);
 int kmi_data_read(unsigned long base);
+int kmi_data_pending(unsigned long base);
 
 /* Keyboard specific calls */
 char kmi_keyboard_read(unsigned long base, struct keyboard_state *state);
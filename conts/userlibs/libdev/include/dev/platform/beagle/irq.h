@@ -9,5 +9,6 @@
 
 #define IRQ_TIMER0	37
 #define IRQ_TIMER1	38
+#define IRQ_UART1	73
 
 #endif /* __LIBDEV_BEAGLE_IRQ_H__  */
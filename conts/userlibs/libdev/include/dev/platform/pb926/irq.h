@@ -8,6 +8,7 @@
 #define __LIBDEV_PB926_IRQ_H__
 
 #define IRQ_TIMER1		5
+#define IRQ_UART1		13
 #define IRQ_CLCD0		16
 #define IRQ_KEYBOARD0           34
 #define IRQ_MOUSE0              35
@@ -8,6 +8,7 @@
 #define __LIBDEV_PBA9_IRQ_H__
 
 #define IRQ_TIMER1		35
+#define IRQ_UART1		38
 #define IRQ_KEYBOARD0		44
 #define IRQ_MOUSE0		45
 #define IRQ_CLCD0		46
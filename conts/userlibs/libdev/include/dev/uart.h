@@ -13,6 +13,21 @@ char uart_rx_char(unsigned long uart_base);
 void uart_set_baudrate(unsigned long uart_base, unsigned int val);
 void uart_init(unsigned long base);
 
+/*
+ * Interrupt driven operation. Fifos are turned on, and the
+ * fifo status checks never block, so that a driver thread can
+ * move as many bytes as fit on each interrupt.
+ */
+#define UART_IRQ_RX		(1 << 0)	/* Rx data ready or rx timeout */
+#define UART_IRQ_TX		(1 << 1)	/* Tx fifo drained to its level */
+
+void uart_fifo_enable(unsigned long uart_base);
+int uart_tx_full(unsigned long uart_base);
+int uart_rx_empty(unsigned long uart_base);
+void uart_irq_enable(unsigned long uart_base, unsigned int irqs);
+void uart_irq_disable(unsigned long uart_base, unsigned int irqs);
+unsigned int uart_irq_status(unsigned long uart_base);
+
 /*
  * Base of primary uart used for printf
  */
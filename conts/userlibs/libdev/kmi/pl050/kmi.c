@@ -15,6 +15,12 @@ void kmi_rx_irq_enable(unsigned long base)
 	*(volatile unsigned long *)(base + PL050_KMICR) = KMI_RXINTR;
 }
 
+/* Tell if there is received data to read */
+int kmi_data_pending(unsigned long base)
+{
+	return *(volatile unsigned long *)(base + PL050_KMISTAT) & KMI_RXFULL;
+}
+
 int kmi_data_read(unsigned long base)
 {
 	/* Check and return if data present */
@@ -41,6 +41,68 @@ char uart_rx_char(unsigned long uart_base)
 
 }
 
+void uart_fifo_enable(unsigned long uart_base)
+{
+	uart_enable_fifo(uart_base);
+}
+
+/* Only the empty state of the tx fifo is visible in lsr */
+int uart_tx_full(unsigned long uart_base)
+{
+	return !(read(uart_base + OMAP_UART_LSR) & OMAP_UART_TXFE);
+}
+
+int uart_rx_empty(unsigned long uart_base)
+{
+	return !(read(uart_base + OMAP_UART_LSR) & OMAP_UART_RXFNE);
+}
+
+#define OMAP_UART_IER_RHR		(1 << 0)
+#define OMAP_UART_IER_THR		(1 << 1)
+static unsigned int omap_uart_ier_bits(unsigned int irqs)
+{
+	unsigned int bits = 0;
+
+	if (irqs & UART_IRQ_RX)
+		bits |= OMAP_UART_IER_RHR;
+	if (irqs & UART_IRQ_TX)
+		bits |= OMAP_UART_IER_THR;
+
+	return bits;
+}
+
+void uart_irq_enable(unsigned long uart_base, unsigned int irqs)
+{
+	u32 reg = read(uart_base + OMAP_UART_IER);
+
+	write(reg | omap_uart_ier_bits(irqs), uart_base + OMAP_UART_IER);
+}
+
+void uart_irq_disable(unsigned long uart_base, unsigned int irqs)
+{
+	u32 reg = read(uart_base + OMAP_UART_IER);
+
+	write(reg & ~omap_uart_ier_bits(irqs), uart_base + OMAP_UART_IER);
+}
+
+/*
+ * Omap clears irqs by servicing their source, so status is
+ * derived from line status and the enabled irqs.
+ */
+unsigned int uart_irq_status(unsigned long uart_base)
+{
+	u32 ier = read(uart_base + OMAP_UART_IER);
+	u32 lsr = read(uart_base + OMAP_UART_LSR);
+	unsigned int irqs = 0;
+
+	if ((ier & OMAP_UART_IER_RHR) && (lsr & OMAP_UART_RXFNE))
+		irqs |= UART_IRQ_RX;
+	if ((ier & OMAP_UART_IER_THR) && (lsr & OMAP_UART_TXFE))
+		irqs |= UART_IRQ_TX;
+
+	return irqs;
+}
+
 void uart_set_baudrate(unsigned long uart_base, u32 baudrate)
 {
 	u32 clk_div;
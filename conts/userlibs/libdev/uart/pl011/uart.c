@@ -45,6 +45,74 @@ char uart_rx_char(unsigned long base)
 	return (char)read((base + PL011_UARTDR));
 }
 
+void uart_fifo_enable(unsigned long base)
+{
+	pl011_enable_fifos(base);
+
+	/* Interrupt at 1/2 full rx fifo, or 1/8 full tx fifo */
+	write((2 << 3) | 0, base + PL011_UARTIFLS);
+}
+
+int uart_tx_full(unsigned long base)
+{
+	return read(base + PL011_UARTFR) & PL011_TXFF;
+}
+
+int uart_rx_empty(unsigned long base)
+{
+	return read(base + PL011_UARTFR) & PL011_RXFE;
+}
+
+static unsigned int pl011_irq_bits(unsigned int irqs)
+{
+	unsigned int bits = 0;
+
+	/*
+	 * Rx timeout fires when a partly filled rx fifo goes
+	 * idle, so typed characters are not held back by the fifo.
+	 */
+	if (irqs & UART_IRQ_RX)
+		bits |= PL011_RXIRQ | PL011_RXTIMEOUTIRQ;
+	if (irqs & UART_IRQ_TX)
+		bits |= PL011_TXIRQ;
+
+	return bits;
+}
+
+void uart_irq_enable(unsigned long base, unsigned int irqs)
+{
+	unsigned int val = read(base + PL011_UARTIMSC);
+
+	write(val | pl011_irq_bits(irqs), base + PL011_UARTIMSC);
+}
+
+void uart_irq_disable(unsigned long base, unsigned int irqs)
+{
+	unsigned int val = read(base + PL011_UARTIMSC);
+
+	write(val & ~pl011_irq_bits(irqs), base + PL011_UARTIMSC);
+}
+
+/*
+ * Returns pending, unmasked irqs and clears them. Tx and rx
+ * irqs are level based on fifo fill, so clearing them only
+ * holds until the fifos are serviced.
+ */
+unsigned int uart_irq_status(unsigned long base)
+{
+	unsigned int mis = read(base + PL011_UARTMIS);
+	unsigned int irqs = 0;
+
+	if (mis & (PL011_RXIRQ | PL011_RXTIMEOUTIRQ))
+		irqs |= UART_IRQ_RX;
+	if (mis & PL011_TXIRQ)
+		irqs |= UART_IRQ_TX;
+
+	write(mis, base + PL011_UARTICR);
+
+	return irqs;
+}
+
 /*
  * Sets the baud rate in kbps. It is recommended to use
  * standard rates such as: 1200, 2400, 3600, 4800, 7200,
@@ -0,0 +1,14 @@
+/*
+ * Reading kernel operation accounting
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_ACCOUNTING_H__
+#define __L4LIB_ACCOUNTING_H__
+
+#include <l4lib/types.h>
+#include <l4/api/accounting.h>
+
+int l4_accounting_read(int cpu, struct system_accounting *acc, int reset);
+
+#endif /* __L4LIB_ACCOUNTING_H__ */
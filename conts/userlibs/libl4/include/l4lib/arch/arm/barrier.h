@@ -0,0 +1,25 @@
+/*
+ * Memory barriers for memory shared between threads and tasks,
+ * or with the kernel, that other cpus may be accessing.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_ARM_BARRIER_H__
+#define __L4LIB_ARM_BARRIER_H__
+
+/*
+ * On smp, another cpu sees our accesses in program order only
+ * across a data memory barrier. It is a cp15 operation on v6, and
+ * one that is allowed in user mode. A single cpu always sees its
+ * own accesses in order, so there only the compiler is held back.
+ */
+#if defined(CONFIG_SMP) && defined(CONFIG_SUBARCH_V7)
+#define l4_smp_mb()	__asm__ __volatile__ ("dmb" : : : "memory")
+#elif defined(CONFIG_SMP) && defined(CONFIG_SUBARCH_V6)
+#define l4_smp_mb()	__asm__ __volatile__ ("mcr p15, 0, %0, c7, c10, 5" \
+					      : : "r" (0) : "memory")
+#else
+#define l4_smp_mb()	__asm__ __volatile__ ("" : : : "memory")
+#endif
+
+#endif /* __L4LIB_ARM_BARRIER_H__ */
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <l4/macros.h>
 #include L4LIB_INC_ARCH(syscalls.h)
+#include L4LIB_INC_ARCH(irq.h)
 
 /*
  * NOTE:
@@ -269,10 +270,284 @@ static inline int l4_return_extended(int retval, unsigned int size,
 	return l4_ipc(sender, L4_NILTHREAD, flags);
 }
 
+/*
+ * Sends a request in the primary mrs, and receives up to size bytes
+ * of reply into buf as extended ipc in the same call. The buffer
+ * pointer takes the mr at index, which must not carry the request.
+ */
 static inline int l4_sendrecv_extended(l4id_t to, l4id_t from,
-				       unsigned int tag, void *buf)
+				       unsigned int tag, int index,
+				       unsigned int size, void *buf)
+{
+	unsigned int flags = 0;
+
+	BUG_ON(to == L4_NILTHREAD || from == L4_NILTHREAD);
+	l4_set_tag(tag);
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_EXTENDED);
+	flags = l4_set_ipc_size(flags, size);
+	flags = l4_set_ipc_msg_index(flags, index);
+
+	write_mr(index, (unsigned long)buf);
+
+	return l4_ipc(to, from, flags);
+}
+
+/*
+ * Long IPC copies up to 64KB straight from the sender's buffer
+ * into the receiver's. The buffer pointer and size are passed in
+ * two consecutive mrs. A successful receive returns the number of
+ * bytes transferred.
+ */
+static inline int l4_send_long(l4id_t to, unsigned int tag,
+			       unsigned int size, void *buf)
+{
+	unsigned int flags = 0;
+
+	l4_set_tag(tag);
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_LONG);
+	flags = l4_set_ipc_msg_index(flags, L4SYS_ARG0);
+
+	write_mr(L4SYS_ARG0, (unsigned long)buf);
+	write_mr(L4SYS_ARG1, size);
+
+	return l4_ipc(to, L4_NILTHREAD, flags);
+}
+
+static inline int l4_receive_long(l4id_t from, unsigned int size, void *buf)
+{
+	unsigned int flags = 0;
+	int err;
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_LONG);
+	flags = l4_set_ipc_msg_index(flags, L4SYS_ARG0);
+
+	write_mr(L4SYS_ARG0, (unsigned long)buf);
+	write_mr(L4SYS_ARG1, size);
+
+	if ((err = l4_ipc(L4_NILTHREAD, from, flags)) < 0)
+		return err;
+
+	return read_mr(L4SYS_ARG1);
+}
+
+/*
+ * Builds a flexpage for map and grant items, or for a receive window.
+ * Base must be page aligned and order is the log2 of the size.
+ */
+static inline unsigned int l4_fpage(unsigned long base, unsigned int order,
+				    unsigned int rights)
 {
-	/* Need to imitate sendrecv but with extended send/recv flags */
+	return (base & ~PAGE_MASK) | (order & L4_FPAGE_ORDER_MASK) |
+	       (rights & L4_FPAGE_ATTR_MASK);
+}
+
+/*
+ * Items travel in ARG2, and a receiver's window in ARG3, so that
+ * ARG0 and ARG1 are left for the request that goes with them.
+ */
+static inline unsigned int l4_map_flags(unsigned int type, int grant)
+{
+	unsigned int flags = 0;
+
+	flags = l4_set_ipc_flags(flags, type);
+	flags |= grant ? L4_IPC_FLAGS_GRANT : L4_IPC_FLAGS_MAP;
+
+	return l4_set_ipc_msg_index(flags, L4SYS_ARG2);
+}
+
+/*
+ * Maps the pages in fpage into the receiver's window. With grant
+ * set the pages are also removed from the sender.
+ */
+static inline int l4_send_map(l4id_t to, unsigned int tag,
+			      unsigned int fpage, int grant)
+{
+	l4_set_tag(tag);
+	write_mr(L4SYS_ARG2, fpage);
+
+	return l4_ipc(to, L4_NILTHREAD,
+		      l4_map_flags(L4_IPC_FLAGS_SHORT, grant));
+}
+
+/*
+ * Sends a request with the pages in fpage as a map item, and
+ * waits for the reply in the same call.
+ */
+static inline int l4_sendrecv_map(l4id_t to, l4id_t from, unsigned int tag,
+				  unsigned int fpage)
+{
+	BUG_ON(to == L4_NILTHREAD || from == L4_NILTHREAD);
+	l4_set_tag(tag);
+	write_mr(L4SYS_ARG2, fpage);
+
+	return l4_ipc(to, from, l4_map_flags(L4_IPC_FLAGS_SHORT, 0));
+}
+
+static inline int __l4_receive_map(l4id_t from, unsigned int type,
+				   unsigned int window,
+				   unsigned int *received)
+{
+	unsigned int flags = 0;
+	int err;
+
+	flags = l4_set_ipc_flags(flags, type);
+	flags = l4_set_ipc_msg_index(flags, L4SYS_ARG2);
+
+	if (window) {
+		flags |= L4_IPC_FLAGS_WINDOW;
+		write_mr(L4SYS_ARG3, window);
+	}
+
+	if ((err = l4_ipc(L4_NILTHREAD, from, flags)) < 0)
+		return err;
+
+	*received = window ? read_mr(L4SYS_ARG3) : 0;
+
+	return 0;
+}
+
+/*
+ * Receives accepting a map or grant item into window, or no item
+ * if window is 0. On return *received holds the flexpage that was
+ * mapped, or 0 if none.
+ */
+static inline int l4_receive_map(l4id_t from, unsigned int window,
+				 unsigned int *received)
+{
+	return __l4_receive_map(from, L4_IPC_FLAGS_SHORT, window, received);
+}
+
+/* As l4_receive_map(), also taking the rest of the utcb */
+static inline int l4_receive_full_map(l4id_t from, unsigned int window,
+				      unsigned int *received)
+{
+	return __l4_receive_map(from, L4_IPC_FLAGS_FULL, window, received);
+}
+
+/*
+ * Sends a request, and takes the pages of a map item in the reply
+ * into window in the same call. What was mapped is passed back in
+ * received, which is 0 for a reply without an item.
+ */
+static inline int l4_sendrecv_window(l4id_t to, l4id_t from, unsigned int tag,
+				     unsigned int window,
+				     unsigned int *received)
+{
+	unsigned int flags = 0;
+	int err;
+
+	BUG_ON(to == L4_NILTHREAD || from == L4_NILTHREAD);
+	l4_set_tag(tag);
+	write_mr(L4SYS_ARG3, window);
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_SHORT);
+	flags = l4_set_ipc_msg_index(flags, L4SYS_ARG2);
+	flags |= L4_IPC_FLAGS_WINDOW;
+
+	if ((err = l4_ipc(to, from, flags)) < 0)
+		return err;
+
+	*received = read_mr(L4SYS_ARG3);
+
+	return 0;
+}
+
+/*
+ * Posts to a notify slot of the given thread without blocking.
+ */
+static inline int l4_notify(l4id_t to, int slot)
+{
+	unsigned int flags = 0;
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_NOTIFY);
+	flags = l4_set_ipc_msg_index(flags, slot);
+
+	return l4_ipc(to, L4_NILTHREAD, flags);
+}
+
+/*
+ * Returns the pending count of a notify slot, waiting for one if
+ * there is none. The slot is read destructively as with irqs.
+ */
+static inline int l4_notify_wait(int slot)
+{
+	unsigned int flags = 0;
+	int count;
+
+	if ((count = l4_atomic_dest_readb(&(l4_get_utcb()->notify[slot]))))
+		return count;
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_NOTIFY);
+	flags = l4_set_ipc_msg_index(flags, slot);
+
+	return l4_ipc(L4_NILTHREAD, L4_ANYTHREAD, flags);
+}
+
+/*
+ * Raises notification bits in the given thread without blocking.
+ * Raising none tells whether the thread still exists.
+ */
+static inline int l4_signal(l4id_t to, unsigned int bits)
+{
+	unsigned int flags = 0;
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_SIGNAL);
+	flags = l4_set_ipc_msg_index(flags, L4SYS_ARG0);
+
+	write_mr(L4SYS_ARG0, bits);
+
+	return l4_ipc(to, L4_NILTHREAD, flags);
+}
+
+/*
+ * Waits for any of the notification bits in mask. The pending
+ * ones are cleared and returned in *bits. Bits below
+ * L4_NOTIFY_IRQ_BITS are raised by irqs on the same notify slot.
+ */
+static inline int l4_signal_wait(unsigned int mask, unsigned int *bits)
+{
+	unsigned int flags = 0;
+	int err;
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_SIGNAL);
+	flags = l4_set_ipc_msg_index(flags, L4SYS_ARG0);
+
+	write_mr(L4SYS_ARG0, mask);
+
+	if ((err = l4_ipc(L4_NILTHREAD, L4_ANYTHREAD, flags)) < 0)
+		return err;
+
+	*bits = read_mr(L4SYS_ARG0);
+
+	return 0;
+}
+
+/*
+ * As l4_signal_wait(), but gives up with -ETIMEDOUT once ms
+ * milliseconds pass without any of the bits. The kernel rounds
+ * the timeout up to scheduler ticks.
+ */
+static inline int l4_signal_wait_timeout(unsigned int mask,
+					 unsigned int *bits,
+					 unsigned int ms)
+{
+	unsigned int flags = 0;
+	int err;
+
+	flags = l4_set_ipc_flags(flags, L4_IPC_FLAGS_SIGNAL);
+	flags = l4_set_ipc_msg_index(flags, L4SYS_ARG0);
+	flags |= L4_IPC_FLAGS_TIMEOUT;
+
+	write_mr(L4SYS_ARG0, mask);
+	write_mr(L4SYS_ARG1, ms);
+
+	if ((err = l4_ipc(L4_NILTHREAD, L4_ANYTHREAD, flags)) < 0)
+		return err;
+
+	*bits = read_mr(L4SYS_ARG0);
+
 	return 0;
 }
 
@@ -320,6 +595,21 @@ static inline int l4_ipc_return(int retval)
 	return l4_ipc(sender, L4_NILTHREAD, 0);
 }
 
+/*
+ * As l4_ipc_return(), with the pages in fpage as a map item. The
+ * sender must be waiting on a window, else the reply is refused.
+ */
+static inline int l4_ipc_return_map(int retval, unsigned int fpage)
+{
+	l4id_t sender = l4_get_sender();
+
+	l4_set_retval(retval);
+	write_mr(L4SYS_ARG2, fpage);
+
+	return l4_ipc(sender, L4_NILTHREAD,
+		      l4_map_flags(L4_IPC_FLAGS_SHORT, 0));
+}
+
 void *l4_new_virtual(int npages);
 void *l4_del_virtual(void *virt, int npages);
 
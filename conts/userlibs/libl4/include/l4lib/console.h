@@ -0,0 +1,45 @@
+/*
+ * Console log protocol of the uart service
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_CONSOLE_H__
+#define __L4LIB_CONSOLE_H__
+
+#include <l4lib/types.h>
+#include <l4lib/ring.h>
+#include <l4/macros.h>
+#include INC_GLUE(memory.h)
+
+/*
+ * A client task logs through one page that it maps to the console,
+ * formatted as an l4_ring of these. Each entry is a whole line of
+ * one thread, or a piece of a line too long for one entry, and the
+ * console prints it tagged with the thread and time it was written.
+ */
+#define CONSOLE_LINE_MAX	80
+
+struct console_entry {
+	l4id_t tid;
+	u32 sec;
+	u32 usec;
+	u16 len;
+	u16 flags;
+	char text[CONSOLE_LINE_MAX];
+};
+
+/* Entry flags */
+#define CONSOLE_PARTIAL		(1 << 0)	/* Line goes on in the next */
+
+#define CONSOLE_RING_ORDER	PAGE_BITS
+#define CONSOLE_RING_SIZE	(1 << CONSOLE_RING_ORDER)
+
+/* Threads of a task that get a line buffer of their own */
+#define CONSOLE_THREADS_MAX	16
+
+int l4_console_attach(l4id_t console);
+int l4_console_detach(void);
+int l4_console_flush(void);
+unsigned int l4_console_dropped(void);
+
+#endif /* __L4LIB_CONSOLE_H__ */
@@ -12,6 +12,8 @@ void exregs_set_read(struct exregs_data *exregs);
 
 unsigned long exregs_get_utcb(struct exregs_data *s);
 unsigned long exregs_get_stack(struct exregs_data *s);
+
+int l4_thread_cputime(l4id_t tid, u64 *user_time, u64 *kernel_time);
 /*
 exregs_set_stack(unsigned long sp)
 exregs_set_pc(unsigned long pc)
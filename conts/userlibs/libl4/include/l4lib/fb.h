@@ -0,0 +1,63 @@
+/*
+ * Client side of the clcd service framebuffer
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_FB_H__
+#define __L4LIB_FB_H__
+
+#include <l4lib/types.h>
+#include <l4/macros.h>
+#include <l4/api/ipc.h>
+
+/*
+ * The service double buffers the display. Both buffers are mapped
+ * uncached to its owner, as the controller reads them from memory.
+ * The owner draws into a cached shadow of the screen, and marks the
+ * rectangles it changed. A present writes those out to the back
+ * buffer, along with the ones of the frame before that the back
+ * buffer has not seen yet, and the buffers are swapped at the next
+ * vertical sync. Nothing is ever read back from the buffers.
+ */
+struct fb_rect {
+	u16 x;
+	u16 y;
+	u16 w;
+	u16 h;
+};
+
+/* Rectangles kept per frame, beyond which they are merged */
+#define FB_DAMAGE_MAX		16
+
+#define FB_BUFFER_ORDER		20
+#define FB_BUFFER_SIZE		(1 << FB_BUFFER_ORDER)
+
+/* Both buffers are mapped as one flexpage of this order */
+#define FB_WINDOW_ORDER		(FB_BUFFER_ORDER + 1)
+#define FB_WINDOW_SIZE		(1 << FB_WINDOW_ORDER)
+
+struct l4_fb {
+	l4id_t service;
+	unsigned int width;
+	unsigned int height;
+	unsigned int stride;		/* Bytes per row */
+	void *buf[2];			/* Uncached, as the controller reads */
+	int back;			/* Buffer a present writes out to */
+	void *shadow;			/* Cached, and drawn into */
+	int ndamage;
+	struct fb_rect damage[FB_DAMAGE_MAX];
+	int nstale;			/* Damage the back buffer lacks */
+	struct fb_rect stale[FB_DAMAGE_MAX];
+};
+
+static inline void *l4_fb_canvas(struct l4_fb *fb)
+{
+	return fb->shadow;
+}
+
+int l4_fb_attach(l4id_t service, struct l4_fb *fb, void *window,
+		 void *shadow);
+void l4_fb_damage(struct l4_fb *fb, int x, int y, int w, int h);
+int l4_fb_present(struct l4_fb *fb);
+
+#endif /* __L4LIB_FB_H__ */
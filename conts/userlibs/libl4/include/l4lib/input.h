@@ -0,0 +1,47 @@
+/*
+ * Input events of the kmi service
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_INPUT_H__
+#define __L4LIB_INPUT_H__
+
+#include <l4lib/types.h>
+#include <l4lib/ring.h>
+#include <l4/macros.h>
+#include INC_GLUE(memory.h)
+
+/*
+ * A subscriber maps one page to the kmi service, formatted as
+ * an l4_ring of these, and the service queues every key press
+ * and mouse packet in it stamped with the time it came in.
+ */
+struct input_event {
+	u32 sec;
+	u32 usec;
+	u16 type;
+	u16 code;	/* Key character, or mouse buttons held */
+	s16 dx;		/* Mouse movement, right and up positive */
+	s16 dy;
+};
+
+/* Event types */
+#define INPUT_EV_KEY		1
+#define INPUT_EV_MOUSE		2
+
+/* Mouse buttons in code */
+#define INPUT_BTN_LEFT		(1 << 0)
+#define INPUT_BTN_RIGHT		(1 << 1)
+#define INPUT_BTN_MIDDLE	(1 << 2)
+
+#define INPUT_RING_ORDER	PAGE_BITS
+#define INPUT_RING_SIZE		(1 << INPUT_RING_ORDER)
+
+/* Read flags */
+#define INPUT_WAIT		(1 << 0)	/* Sleep until there are events */
+
+int l4_input_subscribe(l4id_t kmi, int slot);
+int l4_input_unsubscribe(void);
+int l4_input_read(struct input_event *ev, int max, unsigned int flags);
+
+#endif /* __L4LIB_INPUT_H__ */
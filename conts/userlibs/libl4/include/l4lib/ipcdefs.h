@@ -63,7 +63,10 @@
 #define L4_REQUEST_CAPABILITY		50	/* Request a capability from pager */
 extern l4id_t pagerid;
 
-/* For ipc to uart service (TODO: Shared mapping buffers???) */
+/*
+ * For ipc to uart service. Buffers go in full ipc (send) and in
+ * extended ipc (recv), see l4lib/uart.h for the client side.
+ */
 #define L4_IPC_TAG_UART_SENDCHAR	51	/* Single char send (output) */
 #define L4_IPC_TAG_UART_RECVCHAR	52	/* Single char recv (input) */
 #define L4_IPC_TAG_UART_SENDBUF		53	/* Buffered send */
@@ -74,4 +77,21 @@ extern l4id_t pagerid;
 #define L4_IPC_TAG_TIMER_SLEEP				56
 #define L4_IPC_TAG_TIMER_WAKE_THREADS		57
 
+/* Intra container ipc of uart service threads */
+#define L4_IPC_TAG_UART_IRQ		58	/* Irq thread moved data */
+#define L4_IPC_TAG_UART_TIMEOUT		59	/* A timed recv expired */
+
+/* Console of the uart service, see l4lib/console.h */
+#define L4_IPC_TAG_CONSOLE_ATTACH	60	/* Client maps its log ring */
+#define L4_IPC_TAG_CONSOLE_DETACH	65	/* Client is done logging */
+
+/* For ipc to kmi service, see l4lib/input.h */
+#define L4_IPC_TAG_INPUT_SUBSCRIBE	61	/* Client maps its event ring */
+#define L4_IPC_TAG_INPUT_UNSUBSCRIBE	66	/* Client takes no more events */
+
+/* For ipc to clcd service, see l4lib/fb.h */
+#define L4_IPC_TAG_FB_ATTACH		62	/* Client maps the framebuffers */
+#define L4_IPC_TAG_FB_PRESENT		63	/* Flip to the back buffer */
+#define L4_IPC_TAG_FB_FLIPPED		64	/* Irq thread saw the flip taken */
+
 #endif /* __IPCDEFS_H__ */
@@ -1,7 +1,11 @@
 #ifndef __L4LIB_IRQ_H__
 #define __L4LIB_IRQ_H__
 
+#include <l4/api/container.h>
 
 int l4_irq_wait(int slot, int irqnum);
+int l4_irq_ack_wait(int irqnum);
+int l4_irq_slot_count(int slot);
+int l4_irq_latency(int irqnum, struct irq_latency_stats *stats, int reset);
 
 #endif /* __L4LIB_IRQ_H__ */
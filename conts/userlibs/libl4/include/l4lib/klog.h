@@ -0,0 +1,14 @@
+/*
+ * Reading the kernel log
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_KLOG_H__
+#define __L4LIB_KLOG_H__
+
+#include <l4lib/types.h>
+#include <l4/api/container.h>
+
+int l4_kernel_log_read(int cpu, struct kernel_log *log);
+
+#endif /* __L4LIB_KLOG_H__ */
@@ -0,0 +1,61 @@
+#ifndef __API_CONTAINER_H__
+#define __API_CONTAINER_H__
+#include <l4lib/types.h>
+
+/* Container control requests, available to pagers */
+#define CONTAINER_CONTROL_IRQ_LATENCY	0
+#define CONTAINER_CONTROL_TRACE_MAP	1
+#define CONTAINER_CONTROL_TRACE_MASK	2
+#define CONTAINER_CONTROL_ACCOUNTING	3
+#define CONTAINER_CONTROL_LOG		4
+
+/*
+ * Request flags. IRQ_LATENCY takes the irq number in the
+ * low bits, ACCOUNTING a cpu. RESET clears what was read
+ * in the same go.
+ *
+ * TRACE_MAP takes a cpu in flags and maps its trace ring
+ * read-only at the page aligned address in the buffer
+ * argument. TRACE_MASK takes the categories to record
+ * and returns those recorded before.
+ *
+ * LOG takes a cpu and reads from its kernel log into a
+ * struct kernel_log.
+ */
+#define CONTAINER_CONTROL_IRQ_MASK	0x0000FFFF
+#define CONTAINER_CONTROL_CPU_MASK	0x0000FFFF
+#define CONTAINER_CONTROL_RESET		0x80000000
+
+/* Histogram buckets are log2 of the latency in clock counts */
+#define IRQ_LATENCY_BUCKETS		16
+
+/*
+ * Time from an irq to its registered thread being scheduled,
+ * in clock source counts. clock_hz gives the count rate.
+ */
+struct irq_latency_stats {
+	u32 count;
+	u32 min;
+	u32 max;
+	u32 avg;
+	u64 total;
+	u32 clock_hz;
+	u32 hist[IRQ_LATENCY_BUCKETS];
+};
+
+/*
+ * Kernel log bytes from pos on, up to size. Each cpu keeps its
+ * most recent output only, so if pos has been overwritten the
+ * read starts at the oldest byte kept and skipped tells how many
+ * were lost. On return pos is past the last byte copied and size
+ * is the number of bytes copied.
+ */
+struct kernel_log {
+	u32 pos;
+	u32 size;
+	u32 skipped;
+	u32 reserved;
+	char data[];
+};
+
+#endif /* __API_CONTAINER_H__ */
@@ -13,6 +13,7 @@
 #define EXREGS_SET_PAGER		1
 #define	EXREGS_SET_UTCB			2
 #define EXREGS_READ			4
+#define EXREGS_CPUTIME			8	/* Read only */
 
 #define EXREGS_VALID_REGULAR_REGS 			\
 	(FIELD_TO_BIT(exregs_context_t, r0) |		\
@@ -43,6 +44,8 @@ struct exregs_data {
 	u32 flags;
 	l4id_t pagerid;
 	unsigned long utcb_address;
+	u64 user_time;		/* Microseconds in userland */
+	u64 kernel_time;	/* Microseconds in kernel */
 };
 
 
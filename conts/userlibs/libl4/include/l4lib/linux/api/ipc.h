@@ -14,6 +14,9 @@
 #define L4_IPC_FLAGS_SHORT		0x00000000	/* Short IPC involves just primary message registers */
 #define L4_IPC_FLAGS_FULL		0x00000001	/* Full IPC involves full UTCB copy */
 #define L4_IPC_FLAGS_EXTENDED		0x00000002	/* Extended IPC can page-fault and copy up to 2KB */
+#define L4_IPC_FLAGS_LONG		0x00000003	/* Long IPC copies directly between user buffers, up to 64KB */
+#define L4_IPC_FLAGS_NOTIFY		0x00000004	/* Notify IPC posts to a utcb notify slot without blocking */
+#define L4_IPC_FLAGS_SIGNAL		0x00000005	/* Signal IPC raises or waits on notification bits */
 
 /* Extended IPC extra fields */
 #define L4_IPC_FLAGS_MSG_INDEX_MASK	0x00000FF0	/* Index of message register with buffer pointer */
@@ -21,7 +24,50 @@
 #define L4_IPC_FLAGS_SIZE_SHIFT		16
 #define L4_IPC_FLAGS_MSG_INDEX_SHIFT	4
 
+/* Map and grant items, only with short or full IPC */
+#define L4_IPC_FLAGS_MAP		0x00001000	/* Sender maps pages */
+#define L4_IPC_FLAGS_GRANT		0x00002000	/* Sender grants pages, losing its own mapping */
+#define L4_IPC_FLAGS_ITEM_MASK		0x00003000
+#define L4_IPC_FLAGS_WINDOW		0x00008000	/* Receiver accepts an item */
+
+/* Signal receives time out, after the ms in the register after the mask */
+#define L4_IPC_FLAGS_TIMEOUT		0x00004000
+
+/*
+ * An item is a flexpage in the message register given by the index
+ * field. The page aligned base address is combined with the log2 of
+ * the size and the access rights. Uncached items are writable device
+ * or shared memory, and must be mapped uncached by the sender too.
+ * The receiver passes the window it accepts pages into in the same
+ * way in the register after that, and gets back the received one
+ * there, so that a sendrecv can both pass an item and accept one.
+ * The part of the window that an item fills must be unmapped.
+ */
+#define L4_FPAGE_ORDER_MASK		0x0000003F
+#define L4_FPAGE_WRITE			0x00000040
+#define L4_FPAGE_EXEC			0x00000080
+#define L4_FPAGE_UNCACHED		0x00000100
+#define L4_FPAGE_ATTR_MASK		0x000001C0
+#define L4_FPAGE_MAX_ORDER		21		/* Up to 2MB per item */
+
 
 #define L4_IPC_EXTENDED_MAX_SIZE	(SZ_1K*2)
 
+/*
+ * Long IPC passes the buffer address in the message register
+ * given by the index field, and the size in the one after it.
+ */
+#define L4_IPC_LONG_MAX_SIZE		SZ_64K
+
+/* Notify IPC takes the notify slot number in the index field */
+
+/*
+ * Signal IPC takes the message register with the notification bits in
+ * the index field. A send raises the bits in the receiver, a receive
+ * waits for any bit in the mask and returns the pending ones cleared.
+ * Bits below L4_NOTIFY_IRQ_BITS are also raised by irqs registered on
+ * the notify slot of the same number.
+ */
+#define L4_NOTIFY_IRQ_BITS		8
+
 #endif /* __IPC_H__ */
@@ -22,6 +22,7 @@
 #define IO_AREA_SECTIONS	(IO_AREA_SIZE / ARM_SECTION_SIZE)
 
 #define USER_KIP_PAGE		0xFF000000
+#define USER_TIME_PAGE		0xFF001000
 
 /* ARM-specific offset in KIP that tells the address of UTCB page */
 #define UTCB_KIP_OFFSET		0x50
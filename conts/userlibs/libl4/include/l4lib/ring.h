@@ -0,0 +1,79 @@
+/*
+ * Shared memory ring channels
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_RING_H__
+#define __L4LIB_RING_H__
+
+#include <l4lib/types.h>
+
+/*
+ * Single producer, single consumer ring of fixed size entries.
+ * It lives in memory shared by both parties, e.g. set up with
+ * mm0 shm or an ipc map item. Head and tail are free running,
+ * each written by one side only.
+ */
+struct l4_ring {
+	volatile u32 head;	/* Written by producer */
+	volatile u32 tail;	/* Written by consumer */
+	volatile u32 waiting;	/* Consumer sleeps on its notify slot */
+	u32 nentries;		/* Always a power of two */
+	u32 entry_size;
+	u8 data[];
+};
+
+/*
+ * One side's view of a ring. The producer notifies the consumer's
+ * slot only when it flushes a batch and the consumer is sleeping.
+ * The other side can write the ring's layout at any time, so it is
+ * checked once and kept here, and only this copy is used after.
+ */
+struct l4_channel {
+	struct l4_ring *ring;
+	l4id_t consumer;	/* Thread to notify on flush */
+	int slot;		/* Notify slot of the consumer */
+	u32 nentries;
+	u32 entry_size;		/* Bytes copied per entry */
+};
+
+/*
+ * A service's end of a channel that a client attached with
+ * l4_channel_attach(). The client's ring page is mapped at
+ * window, and ring is set while it is there.
+ */
+struct l4_channel_port {
+	struct l4_channel ch;
+	void *window;
+	unsigned int order;	/* Log2 size of the window */
+	l4id_t owner;		/* Thread that attached */
+	struct l4_ring *volatile ring;
+};
+
+int l4_ring_init(struct l4_ring *ring, unsigned long mem_size,
+		 unsigned int entry_size);
+
+int l4_channel_init(struct l4_channel *ch, struct l4_ring *ring,
+		    unsigned long mem_size, unsigned int entry_size,
+		    l4id_t consumer, int slot);
+int l4_channel_send(struct l4_channel *ch, void *entry);
+int l4_channel_flush(struct l4_channel *ch);
+int l4_channel_poll(struct l4_channel *ch, void *entry);
+int l4_channel_receive(struct l4_channel *ch, void *entry);
+
+int l4_channel_attach(l4id_t service, unsigned int tag, void *mem,
+		      unsigned int order, unsigned int entry_size);
+int l4_channel_detach(l4id_t service, unsigned int tag);
+
+unsigned int l4_channel_window(struct l4_channel_port *port, int nports);
+struct l4_channel_port *l4_channel_accept(struct l4_channel_port *port,
+					  int nports, l4id_t owner,
+					  unsigned int fpage,
+					  unsigned int entry_size);
+void l4_channel_publish(struct l4_channel_port *port);
+struct l4_channel_port *l4_channel_find(struct l4_channel_port *port,
+					int nports, l4id_t owner);
+void l4_channel_release(struct l4_channel_port *port);
+int l4_channel_reap(struct l4_channel_port *port, int nports);
+
+#endif /* __L4LIB_RING_H__ */
@@ -0,0 +1,13 @@
+/*
+ * Reading system time without entering the kernel
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_TIME_H__
+#define __L4LIB_TIME_H__
+
+#include <l4lib/types.h>
+
+void l4_gettime(u32 *sec, u32 *usec);
+
+#endif /* __L4LIB_TIME_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Reading kernel event trace rings
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_TRACE_H__
+#define __L4LIB_TRACE_H__
+
+#include <l4lib/types.h>
+#include <l4/api/trace.h>
+
+int l4_trace_map(int cpu, void *vaddr);
+int l4_trace_set_mask(u32 mask);
+int l4_trace_read(volatile struct trace_buffer *tb, u32 *tail,
+		  struct trace_event *events, int max);
+
+#endif /* __L4LIB_TRACE_H__ */
@@ -0,0 +1,34 @@
+/*
+ * Client side of the uart service protocol
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __L4LIB_UART_H__
+#define __L4LIB_UART_H__
+
+#include <l4lib/types.h>
+#include <l4/macros.h>
+#include <l4/api/ipc.h>
+#include INC_GLUE(message.h)
+
+/*
+ * Request flags. A blocking recv returns as soon as there is
+ * any input, and with a timeout it fails with -ETIMEDOUT if
+ * there is still none when it expires. A nonblocking request
+ * fails with -EAGAIN instead of waiting.
+ */
+#define UART_NONBLOCK		(1 << 0)
+#define UART_TIMEOUT		(1 << 1)	/* Timeout in ms is given */
+
+/*
+ * Sends go inline in the utcb with full ipc, and receives come
+ * back as extended ipc, so these are the most moved per call.
+ */
+#define UART_SENDBUF_MAX	L4_UTCB_FULL_BUFFER_SIZE
+#define UART_RECVBUF_MAX	L4_IPC_EXTENDED_MAX_SIZE
+
+int l4_uart_send(l4id_t uart, const void *buf, int size, unsigned int flags);
+int l4_uart_recv(l4id_t uart, void *buf, int size, unsigned int flags,
+		 unsigned int timeout_ms);
+
+#endif /* __L4LIB_UART_H__ */
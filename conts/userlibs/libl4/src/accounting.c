@@ -0,0 +1,21 @@
+/*
+ * Reads kernel operation accounting, if the kernel
+ * was built with CONFIG_DEBUG_ACCOUNTING.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/accounting.h>
+#include L4LIB_INC_ARCH(syscalls.h)
+#include <l4/api/container.h>
+
+/*
+ * Takes a snapshot of the counters of a cpu, resetting
+ * them if asked. Only pagers may call this.
+ */
+int l4_accounting_read(int cpu, struct system_accounting *acc, int reset)
+{
+	return l4_container_control(CONTAINER_CONTROL_ACCOUNTING,
+				    (cpu & CONTAINER_CONTROL_CPU_MASK) |
+				    (reset ? CONTAINER_CONTROL_RESET : 0),
+				    acc);
+}
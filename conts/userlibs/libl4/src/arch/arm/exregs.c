@@ -97,3 +97,21 @@ void exregs_set_pc(struct exregs_data *s, unsigned long pc)
 	s->valid_vect |= FIELD_TO_BIT(exregs_context_t, pc);
 }
 
+/* Reads user and kernel times of a thread, in microseconds */
+int l4_thread_cputime(l4id_t tid, u64 *user_time, u64 *kernel_time)
+{
+	struct exregs_data exregs;
+	int err;
+
+	memset(&exregs, 0, sizeof(exregs));
+	exregs.flags = EXREGS_READ | EXREGS_CPUTIME;
+
+	if ((err = l4_exchange_registers(&exregs, tid)) < 0)
+		return err;
+
+	*user_time = exregs.user_time;
+	*kernel_time = exregs.kernel_time;
+
+	return 0;
+}
+
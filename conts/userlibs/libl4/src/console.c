@@ -0,0 +1,260 @@
+/*
+ * Client side of the console log. Once attached, stdout and stderr
+ * are buffered a line per thread, and whole lines go to the console
+ * through a ring shared with it instead of out of the uart.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/console.h>
+#include <l4lib/ring.h>
+#include <l4lib/mutex.h>
+#include <l4lib/time.h>
+#include <l4lib/ipcdefs.h>
+#include L4LIB_INC_ARCH(syslib.h)
+#include L4LIB_INC_ARCH(utcb.h)
+#include <l4/api/errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Line being written by a thread */
+struct console_line {
+	struct utcb *utcb;	/* Thread it belongs to, 0 if unused */
+	l4id_t tid;
+	struct console_entry entry;
+};
+
+static char console_page[CONSOLE_RING_SIZE]
+	__attribute__((aligned(CONSOLE_RING_SIZE)));
+
+static struct l4_channel console_channel;
+static l4id_t console_service;
+static L4_MUTEX(console_lock);
+
+/*
+ * The last line is shared by all threads beyond the rest, so
+ * their lines may run into each other and go untagged.
+ */
+static struct console_line console_lines[CONSOLE_THREADS_MAX];
+#define console_shared_line	(&console_lines[CONSOLE_THREADS_MAX - 1])
+
+/* Lines lost to a console that did not keep up */
+static unsigned int console_dropped;
+
+/*
+ * Queues the line as an entry. If the ring is full, the console
+ * is woken and given the cpu once, and the line is dropped only
+ * if there is still no room, so that writers never wait on it.
+ */
+static void console_ship(struct console_line *line, unsigned int flags)
+{
+	struct console_entry *entry = &line->entry;
+
+	entry->tid = line->tid;
+	entry->flags = flags;
+	l4_gettime(&entry->sec, &entry->usec);
+
+	if (l4_channel_send(&console_channel, entry) < 0) {
+		l4_channel_flush(&console_channel);
+		l4_thread_switch(0);
+
+		if (l4_channel_send(&console_channel, entry) < 0)
+			console_dropped++;
+	}
+
+	entry->len = 0;
+}
+
+/*
+ * Gives a line to the calling thread. What an earlier thread of
+ * the line left unfinished is ended under that thread's tag first.
+ */
+static struct console_line *console_line_own(struct console_line *line,
+					      struct utcb *utcb, l4id_t tid)
+{
+	if (line->tid != tid && line->entry.len)
+		console_ship(line, 0);
+
+	line->utcb = utcb;
+	line->tid = tid;
+
+	return line;
+}
+
+/*
+ * Returns the line of the calling thread. Lines are found by utcb,
+ * and as a utcb is taken by another thread once its owner is gone,
+ * the tag is renewed on each write. Once all lines are taken, those
+ * of threads that no longer exist are taken over.
+ */
+static struct console_line *console_line_get(void)
+{
+	struct utcb *utcb = l4_get_utcb();
+	l4id_t tid = self_tid();
+	struct console_line *line, *free = 0;
+
+	for (line = console_lines; line < console_shared_line; line++) {
+		if (line->utcb == utcb)
+			return console_line_own(line, utcb, tid);
+		if (!line->utcb && !free)
+			free = line;
+	}
+
+	if (free)
+		return console_line_own(free, utcb, tid);
+
+	/* Signalling no bits tells whether a thread exists */
+	for (line = console_lines; line < console_shared_line; line++)
+		if (l4_signal(line->tid, 0) == -ESRCH)
+			return console_line_own(line, utcb, tid);
+
+	line->tid = L4_NILTHREAD;
+	return line;
+}
+
+static size_t console_write(const char *buf, size_t count)
+{
+	struct console_line *line;
+	int shipped = 0;
+
+	l4_mutex_lock(&console_lock);
+
+	/* Lost to a detach that got the lock first */
+	if (!console_channel.ring) {
+		l4_mutex_unlock(&console_lock);
+		return count;
+	}
+
+	line = console_line_get();
+
+	for (size_t i = 0; i < count; i++) {
+		if (buf[i] == '\n') {
+			console_ship(line, 0);
+			shipped = 1;
+			continue;
+		}
+
+		if (line->entry.len == CONSOLE_LINE_MAX) {
+			console_ship(line, CONSOLE_PARTIAL);
+			shipped = 1;
+		}
+		line->entry.text[line->entry.len++] = buf[i];
+	}
+
+	/* One wakeup for all lines of this write */
+	if (shipped)
+		l4_channel_flush(&console_channel);
+
+	l4_mutex_unlock(&console_lock);
+
+	return count;
+}
+
+/*
+ * Ships what the calling thread wrote since its last newline,
+ * e.g. a prompt, or output before the thread goes away.
+ */
+int l4_console_flush(void)
+{
+	struct console_line *line;
+	int err = 0;
+
+	if (!__console_write)
+		return 0;
+
+	l4_mutex_lock(&console_lock);
+
+	if (!console_channel.ring) {
+		l4_mutex_unlock(&console_lock);
+		return 0;
+	}
+
+	line = console_line_get();
+	if (line->entry.len) {
+		console_ship(line, CONSOLE_PARTIAL);
+		err = l4_channel_flush(&console_channel);
+	}
+
+	l4_mutex_unlock(&console_lock);
+
+	return err;
+}
+
+unsigned int l4_console_dropped(void)
+{
+	return console_dropped;
+}
+
+/*
+ * Attaches the task to the console of the uart service. The ring
+ * page goes with the request, and the service replies with the
+ * thread that prints the log and its notify slot.
+ */
+int l4_console_attach(l4id_t console)
+{
+	int err;
+
+	if (__console_write)
+		return -EBUSY;
+
+	if ((err = l4_channel_attach(console, L4_IPC_TAG_CONSOLE_ATTACH,
+				     console_page, CONSOLE_RING_ORDER,
+				     sizeof(struct console_entry))) < 0)
+		return err;
+
+	if ((err = l4_channel_init(&console_channel,
+				   (struct l4_ring *)console_page,
+				   CONSOLE_RING_SIZE,
+				   sizeof(struct console_entry),
+				   (l4id_t)read_mr(L4SYS_ARG0),
+				   (int)read_mr(L4SYS_ARG1))) < 0) {
+		l4_channel_detach(console, L4_IPC_TAG_CONSOLE_DETACH);
+		return err;
+	}
+	console_service = console;
+	__console_write = console_write;
+
+	return 0;
+}
+
+/* Times the console is given the cpu to print what is left */
+#define CONSOLE_DRAIN_TRIES	16
+
+/*
+ * Ends the lines of all threads and detaches from the console,
+ * so that output goes to the uart again. To be called by the
+ * thread that attached, e.g. before the task exits.
+ */
+int l4_console_detach(void)
+{
+	struct l4_ring *ring = console_channel.ring;
+	struct console_line *line;
+	int err;
+
+	if (!__console_write)
+		return 0;
+
+	l4_mutex_lock(&console_lock);
+
+	__console_write = 0;
+
+	for (line = console_lines; line <= console_shared_line; line++)
+		if (line->entry.len)
+			console_ship(line, 0);
+
+	/* The ring goes away with the detach, so let it empty */
+	for (int i = 0; i < CONSOLE_DRAIN_TRIES &&
+	     ring->tail != ring->head; i++) {
+		l4_channel_flush(&console_channel);
+		l4_thread_switch(console_channel.consumer);
+	}
+
+	err = l4_channel_detach(console_service,
+				L4_IPC_TAG_CONSOLE_DETACH);
+
+	memset(console_lines, 0, sizeof(console_lines));
+	console_channel.ring = 0;
+
+	l4_mutex_unlock(&console_lock);
+
+	return err;
+}
@@ -0,0 +1,152 @@
+/*
+ * Drawing to the display of the clcd service. Pixels are drawn
+ * into a cached shadow, and only the rectangles that changed are
+ * written out to the mapped back buffer, once per frame.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/fb.h>
+#include <l4lib/ipcdefs.h>
+#include L4LIB_INC_ARCH(syslib.h)
+#include L4LIB_INC_ARCH(syscalls.h)
+#include <l4/api/errno.h>
+#include <string.h>
+
+/*
+ * Becomes the owner of the display. Both buffers come with the
+ * reply, mapped at window, which must be FB_WINDOW_SIZE of unused
+ * virtual space aligned to its size. Shadow is FB_BUFFER_SIZE of
+ * ordinary memory that is drawn into.
+ */
+int l4_fb_attach(l4id_t service, struct l4_fb *fb, void *window,
+		 void *shadow)
+{
+	unsigned int fpage, mode;
+	int err;
+
+	if ((err = l4_sendrecv_window(service, service, L4_IPC_TAG_FB_ATTACH,
+				      l4_fpage((unsigned long)window,
+					       FB_WINDOW_ORDER,
+					       L4_FPAGE_WRITE |
+					       L4_FPAGE_UNCACHED),
+				      &fpage)) < 0)
+		return err;
+	if ((err = l4_get_retval()) < 0)
+		return err;
+
+	/* Mapped as the service has them, which is uncached */
+	if ((fpage & L4_FPAGE_ORDER_MASK) != FB_WINDOW_ORDER ||
+	    !(fpage & L4_FPAGE_UNCACHED))
+		return -EFAULT;
+
+	mode = read_mr(L4SYS_ARG0);
+
+	fb->service = service;
+	fb->width = mode & 0xFFFF;
+	fb->height = mode >> 16;
+	fb->stride = read_mr(L4SYS_ARG1);
+	fb->buf[0] = window;
+	fb->buf[1] = (char *)window + FB_BUFFER_SIZE;
+	fb->back = err;
+	fb->shadow = shadow;
+	fb->ndamage = 0;
+	fb->nstale = 0;
+
+	/* Both buffers start out blank */
+	memset(shadow, 0, fb->height * fb->stride);
+
+	return 0;
+}
+static void fb_rect_union(struct fb_rect *r, int x, int y, int w, int h)
+{
+	int x1 = max(r->x + r->w, x + w);
+	int y1 = max(r->y + r->h, y + h);
+
+	r->x = min(r->x, x);
+	r->y = min(r->y, y);
+	r->w = x1 - r->x;
+	r->h = y1 - r->y;
+}
+
+/*
+ * Marks a rectangle of the back buffer as drawn to. If there are
+ * more than a present can take, they are merged into one.
+ */
+void l4_fb_damage(struct l4_fb *fb, int x, int y, int w, int h)
+{
+	struct fb_rect *r = fb->damage;
+
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	if (y < 0) {
+		h += y;
+		y = 0;
+	}
+	w = min(w, (int)fb->width - x);
+	h = min(h, (int)fb->height - y);
+
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (fb->ndamage == FB_DAMAGE_MAX) {
+		for (int i = 1; i < fb->ndamage; i++)
+			fb_rect_union(r, fb->damage[i].x, fb->damage[i].y,
+				      fb->damage[i].w, fb->damage[i].h);
+		fb_rect_union(r, x, y, w, h);
+		fb->ndamage = 1;
+		return;
+	}
+
+	r = &fb->damage[fb->ndamage++];
+	r->x = x;
+	r->y = y;
+	r->w = w;
+	r->h = h;
+}
+
+/* Writes a rectangle of the shadow out to the back buffer */
+static void fb_write_rect(struct l4_fb *fb, struct fb_rect *r)
+{
+	unsigned int bpp = fb->stride / fb->width;
+	unsigned long offset = r->y * fb->stride + r->x * bpp;
+	char *src = (char *)fb->shadow + offset;
+	char *dst = (char *)fb->buf[fb->back] + offset;
+
+	for (int y = 0; y < r->h; y++) {
+		memcpy(dst, src, r->w * bpp);
+		src += fb->stride;
+		dst += fb->stride;
+	}
+}
+
+/*
+ * Shows what was drawn from the next vertical sync on. Returns
+ * once the flip is done, after which drawing may go on.
+ */
+int l4_fb_present(struct l4_fb *fb)
+{
+	int err;
+
+	/* The back buffer was last shown before the frame just past */
+	for (int i = 0; i < fb->nstale; i++)
+		fb_write_rect(fb, &fb->stale[i]);
+	for (int i = 0; i < fb->ndamage; i++)
+		fb_write_rect(fb, &fb->damage[i]);
+
+	if ((err = l4_sendrecv(fb->service, fb->service,
+			       L4_IPC_TAG_FB_PRESENT)) < 0)
+		return err;
+	if ((err = l4_get_retval()) < 0)
+		return err;
+
+	fb->back = err;
+
+	/* Now the new back buffer is missing this frame */
+	memcpy(fb->stale, fb->damage, fb->ndamage * sizeof(struct fb_rect));
+	fb->nstale = fb->ndamage;
+	fb->ndamage = 0;
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Subscriber side of kmi service input events. Events come in
+ * batches through a ring shared with the service, which notifies
+ * once per batch if the subscriber is asleep, so reading them
+ * takes no ipc while there are any.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/input.h>
+#include <l4lib/ring.h>
+#include <l4lib/ipcdefs.h>
+#include L4LIB_INC_ARCH(syslib.h)
+#include L4LIB_INC_ARCH(utcb.h)
+#include <l4/api/errno.h>
+
+static char input_page[INPUT_RING_SIZE]
+	__attribute__((aligned(INPUT_RING_SIZE)));
+
+static struct l4_channel input_channel;
+static l4id_t input_service;
+
+/*
+ * Subscribes the calling thread, which is the one to read and
+ * is woken on slot. The ring page goes with the request.
+ */
+int l4_input_subscribe(l4id_t kmi, int slot)
+{
+	int err;
+
+	if (input_channel.ring)
+		return -EBUSY;
+
+	write_mr(L4SYS_ARG0, slot);
+
+	if ((err = l4_channel_attach(kmi, L4_IPC_TAG_INPUT_SUBSCRIBE,
+				     input_page, INPUT_RING_ORDER,
+				     sizeof(struct input_event))) < 0)
+		return err;
+
+	/* The service has the page mapped, so this is where it can fail */
+	if ((err = l4_channel_init(&input_channel,
+				   (struct l4_ring *)input_page,
+				   INPUT_RING_SIZE, sizeof(struct input_event),
+				   self_tid(), slot)) < 0) {
+		l4_channel_detach(kmi, L4_IPC_TAG_INPUT_UNSUBSCRIBE);
+		return err;
+	}
+	input_service = kmi;
+
+	return 0;
+}
+
+/* Stops events, from the thread that subscribed */
+int l4_input_unsubscribe(void)
+{
+	int err;
+
+	if (!input_channel.ring)
+		return -EINVAL;
+
+	if ((err = l4_channel_detach(input_service,
+				     L4_IPC_TAG_INPUT_UNSUBSCRIBE)) < 0)
+		return err;
+
+	input_channel.ring = 0;
+
+	return 0;
+}
+
+/*
+ * Takes up to max events. With INPUT_WAIT it sleeps if there
+ * are none, otherwise it returns 0 at once. Returns the number
+ * of events taken.
+ */
+int l4_input_read(struct input_event *ev, int max, unsigned int flags)
+{
+	int n = 0, err;
+
+	if (!input_channel.ring)
+		return -EINVAL;
+	if (max <= 0)
+		return 0;
+
+	if (flags & INPUT_WAIT) {
+		if ((err = l4_channel_receive(&input_channel, &ev[n])) < 0)
+			return err;
+		n++;
+	}
+
+	while (n < max && l4_channel_poll(&input_channel, &ev[n]) == 0)
+		n++;
+
+	return n;
+}
@@ -6,6 +6,7 @@
 #include L4LIB_INC_ARCH(irq.h)
 #include L4LIB_INC_ARCH(syscalls.h)
 #include <l4/api/irq.h>
+#include <l4/api/container.h>
 
 /*
  * Reads the irq notification slot. Destructive atomic read ensures that
@@ -21,3 +22,30 @@ int l4_irq_wait(int slot, int irqnum)
 		return irqval;
 }
 
+
+/*
+ * Acknowledges this thread's batched irq lines and waits for more.
+ * Returns a mask of notify slots that had irqs. Each slot's count
+ * is taken with l4_irq_slot_count().
+ */
+int l4_irq_ack_wait(int irqnum)
+{
+	return l4_irq_control(IRQ_CONTROL_ACK_WAIT, 0, irqnum);
+}
+
+int l4_irq_slot_count(int slot)
+{
+	return l4_atomic_dest_readb(&(l4_get_utcb()->notify[slot]));
+}
+
+/*
+ * Reads irq to thread latency statistics of irqnum,
+ * resetting them if asked. Only pagers may call this.
+ */
+int l4_irq_latency(int irqnum, struct irq_latency_stats *stats, int reset)
+{
+	return l4_container_control(CONTAINER_CONTROL_IRQ_LATENCY,
+				    (irqnum & CONTAINER_CONTROL_IRQ_MASK) |
+				    (reset ? CONTAINER_CONTROL_RESET : 0),
+				    stats);
+}
@@ -0,0 +1,22 @@
+/*
+ * Reads the kernel log, if the kernel was built
+ * with CONFIG_PRINTK_ASYNC.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/klog.h>
+#include L4LIB_INC_ARCH(syscalls.h)
+#include <l4/api/container.h>
+
+/*
+ * Reads up to log->size bytes of the log of a cpu from
+ * log->pos on into log->data. Reading again from the
+ * returned pos, with size set back to that of data, goes
+ * through the log. Only pagers may call this.
+ */
+int l4_kernel_log_read(int cpu, struct kernel_log *log)
+{
+	return l4_container_control(CONTAINER_CONTROL_LOG,
+				    cpu & CONTAINER_CONTROL_CPU_MASK,
+				    log);
+}
@@ -0,0 +1,335 @@
+/*
+ * Shared memory ring channels with notify slot wakeups.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/ring.h>
+#include <l4lib/exregs.h>
+#include L4LIB_INC_ARCH(syslib.h)
+#include L4LIB_INC_ARCH(barrier.h)
+#include <l4/api/errno.h>
+#include <l4/macros.h>
+#include INC_GLUE(memory.h)
+#include <string.h>
+
+/* Slots are laid out by the channel's own copy of the layout */
+static inline void *l4_ring_entry(struct l4_channel *ch, u32 index)
+{
+	return ch->ring->data + (index & (ch->nentries - 1)) *
+	       align_up(ch->entry_size, sizeof(u32));
+}
+
+/*
+ * Formats mem_size bytes at ring as a ring of as many entries
+ * as fit, rounded down to a power of two.
+ */
+int l4_ring_init(struct l4_ring *ring, unsigned long mem_size,
+		 unsigned int entry_size)
+{
+	unsigned long max;
+
+	entry_size = align_up(entry_size, sizeof(u32));
+
+	if (!entry_size || mem_size < sizeof(*ring) + entry_size)
+		return -EINVAL;
+
+	max = (mem_size - sizeof(*ring)) / entry_size;
+
+	ring->nentries = 1;
+	while (ring->nentries * 2 <= max)
+		ring->nentries *= 2;
+
+	ring->entry_size = entry_size;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->waiting = 0;
+
+	return 0;
+}
+
+/*
+ * Sets up one side's view of a ring in mem_size bytes at ring.
+ * The layout is read from the ring once, checked to be that of
+ * entry_size entries that fit, and kept in the channel. Returns
+ * -EINVAL for a ring laid out otherwise.
+ */
+int l4_channel_init(struct l4_channel *ch, struct l4_ring *ring,
+		    unsigned long mem_size, unsigned int entry_size,
+		    l4id_t consumer, int slot)
+{
+	u32 nentries = ring->nentries;
+	u32 stride = ring->entry_size;
+
+	if (!entry_size || mem_size < sizeof(*ring) ||
+	    stride != align_up(entry_size, sizeof(u32)) ||
+	    !nentries || (nentries & (nentries - 1)) ||
+	    nentries > (mem_size - sizeof(*ring)) / stride)
+		return -EINVAL;
+
+	ch->ring = ring;
+	ch->consumer = consumer;
+	ch->slot = slot;
+	ch->nentries = nentries;
+	ch->entry_size = entry_size;
+
+	return 0;
+}
+
+/*
+ * Head and tail are read from the ring, but only ever as indices
+ * masked by the channel's layout, so a ring written to by the other
+ * side at worst loses or repeats entries, and is never overrun.
+ */
+static int l4_ring_put(struct l4_channel *ch, void *entry)
+{
+	struct l4_ring *ring = ch->ring;
+	u32 head = ring->head;
+
+	if (head - ring->tail >= ch->nentries)
+		return -EAGAIN;
+
+	memcpy(l4_ring_entry(ch, head), entry, ch->entry_size);
+
+	/* Entry must be complete before it is published */
+	l4_smp_mb();
+	ring->head = head + 1;
+
+	return 0;
+}
+
+static int l4_ring_get(struct l4_channel *ch, void *entry)
+{
+	struct l4_ring *ring = ch->ring;
+	u32 tail = ring->tail;
+
+	if (tail == ring->head)
+		return -EAGAIN;
+
+	memcpy(entry, l4_ring_entry(ch, tail), ch->entry_size);
+
+	/* Entry must be read before its space is given back */
+	l4_smp_mb();
+	ring->tail = tail + 1;
+
+	return 0;
+}
+
+/*
+ * Queues an entry without waking the consumer, so that many
+ * entries can go with one notification. Returns -EAGAIN if the
+ * ring is full, in which case the caller should flush and retry.
+ */
+int l4_channel_send(struct l4_channel *ch, void *entry)
+{
+	return l4_ring_put(ch, entry);
+}
+
+/* Wakes up the consumer if it went to sleep on an empty ring */
+int l4_channel_flush(struct l4_channel *ch)
+{
+	l4_smp_mb();
+
+	if (!ch->ring->waiting)
+		return 0;
+
+	ch->ring->waiting = 0;
+
+	return l4_notify(ch->consumer, ch->slot);
+}
+
+/* Takes the next entry if there is one, else returns -EAGAIN */
+int l4_channel_poll(struct l4_channel *ch, void *entry)
+{
+	return l4_ring_get(ch, entry);
+}
+
+/*
+ * Takes the next entry, sleeping on the notify slot only while
+ * the ring is empty. The consumer announces it is about to sleep
+ * and checks the ring once more, so that an entry published in
+ * between is never missed by a producer reading the old flag.
+ */
+int l4_channel_receive(struct l4_channel *ch, void *entry)
+{
+	struct l4_ring *ring = ch->ring;
+	int err;
+
+	for (;;) {
+		if (l4_ring_get(ch, entry) == 0)
+			return 0;
+
+		ring->waiting = 1;
+		l4_smp_mb();
+
+		if (l4_ring_get(ch, entry) == 0) {
+			ring->waiting = 0;
+			return 0;
+		}
+
+		err = l4_notify_wait(ch->slot);
+		ring->waiting = 0;
+
+		if (err < 0)
+			return err;
+	}
+}
+
+/*
+ * Formats a ring of 1 << order bytes at mem, and attaches it to
+ * a service with a request of the given tag. The ring goes to the
+ * service as a map item of the request, and the reply is waited
+ * for in the same ipc, so that the service never waits on us.
+ * Request arguments are taken from ARG0 and ARG1, and the reply
+ * is left in the mrs. A service with no room for another channel
+ * refuses the item, which fails with -ENOIPC.
+ */
+int l4_channel_attach(l4id_t service, unsigned int tag, void *mem,
+		      unsigned int order, unsigned int entry_size)
+{
+	int err;
+
+	/* This also faults in the page before it is mapped */
+	if ((err = l4_ring_init(mem, 1UL << order, entry_size)) < 0)
+		return err;
+
+	if ((err = l4_sendrecv_map(service, service, tag,
+				   l4_fpage((unsigned long)mem, order,
+					    L4_FPAGE_WRITE))) < 0)
+		return err;
+
+	return l4_get_retval();
+}
+
+/* Asks the service to unmap the ring and free its port */
+int l4_channel_detach(l4id_t service, unsigned int tag)
+{
+	int err;
+
+	if ((err = l4_sendrecv(service, service, tag)) < 0)
+		return err;
+
+	return l4_get_retval();
+}
+
+/*
+ * Returns the window of a free port as a flexpage for a service
+ * to receive its next request with, or 0 if all ports are taken.
+ */
+unsigned int l4_channel_window(struct l4_channel_port *port, int nports)
+{
+	for (int i = 0; i < nports; i++)
+		if (!port[i].ring)
+			return l4_fpage((unsigned long)port[i].window,
+					port[i].order, L4_FPAGE_WRITE);
+
+	return 0;
+}
+
+/*
+ * Takes the ring page that came with a request of owner into the
+ * port it was received at. The port's channel wakes owner on slot
+ * 0, which a service producing into the ring sets as it needs
+ * before l4_channel_publish(). Returns the port, or 0 if no whole
+ * ring of entry_size entries came.
+ */
+struct l4_channel_port *l4_channel_accept(struct l4_channel_port *port,
+					  int nports, l4id_t owner,
+					  unsigned int fpage,
+					  unsigned int entry_size)
+{
+	unsigned long base = fpage & ~PAGE_MASK;
+
+	if (!fpage)
+		return 0;
+
+	for (int i = 0; i < nports; i++, port++) {
+		if (port->ring || (unsigned long)port->window != base)
+			continue;
+
+		/* Anything smaller than the window is given back */
+		if ((fpage & L4_FPAGE_ORDER_MASK) != port->order) {
+			l4_unmap(port->window,
+				 1 << ((fpage & L4_FPAGE_ORDER_MASK) -
+				       PAGE_BITS), self_tid());
+			return 0;
+		}
+
+		if (l4_channel_init(&port->ch, port->window,
+				    1UL << port->order, entry_size,
+				    owner, 0) < 0) {
+			l4_unmap(port->window,
+				 1 << (port->order - PAGE_BITS), self_tid());
+			return 0;
+		}
+
+		port->owner = owner;
+		return port;
+	}
+
+	return 0;
+}
+
+/* Makes an accepted port's ring visible to the service's threads */
+void l4_channel_publish(struct l4_channel_port *port)
+{
+	l4_smp_mb();
+	port->ring = port->ch.ring;
+}
+
+/* Returns the port owner attached with, if any */
+struct l4_channel_port *l4_channel_find(struct l4_channel_port *port,
+					int nports, l4id_t owner)
+{
+	for (int i = 0; i < nports; i++)
+		if (port[i].ring && port[i].owner == owner)
+			return &port[i];
+
+	return 0;
+}
+
+/*
+ * Unmaps the ring page of a port, freeing it. Threads of the
+ * service that use the ring must be kept away from it meanwhile.
+ */
+void l4_channel_release(struct l4_channel_port *port)
+{
+	port->ring = 0;
+	l4_smp_mb();
+
+	l4_unmap(port->window, 1 << (port->order - PAGE_BITS), self_tid());
+	port->ch.ring = 0;
+	port->owner = L4_NILTHREAD;
+}
+
+/*
+ * Whether thread tid is gone. The kernel looks the thread up
+ * before checking any capability, so a register read tells this
+ * without the caller holding rights over the thread.
+ */
+static int l4_thread_gone(l4id_t tid)
+{
+	struct exregs_data exregs;
+
+	memset(&exregs, 0, sizeof(exregs));
+	exregs_set_read(&exregs);
+
+	return l4_exchange_registers(&exregs, tid) == -ESRCH;
+}
+
+/*
+ * Releases the ports of owners that are gone, i.e. tasks that
+ * exited without detaching. Returns the number of ports released.
+ */
+int l4_channel_reap(struct l4_channel_port *port, int nports)
+{
+	int n = 0;
+
+	for (int i = 0; i < nports; i++) {
+		if (port[i].ring && l4_thread_gone(port[i].owner)) {
+			l4_channel_release(&port[i]);
+			n++;
+		}
+	}
+
+	return n;
+}
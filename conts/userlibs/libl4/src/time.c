@@ -0,0 +1,33 @@
+/*
+ * Reads system time off the time page that the kernel
+ * maps next to the kip, saving a system call.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/time.h>
+#include <l4lib/kip.h>
+#include <l4lib/macros.h>
+#include L4LIB_INC_ARCH(barrier.h)
+#include <l4/macros.h>
+#include INC_GLUE(memlayout.h)
+
+/*
+ * Resolution is that of the last time update, i.e. a scheduler
+ * tick. Use l4_time() where sub-tick accuracy is required.
+ */
+void l4_gettime(u32 *sec, u32 *usec)
+{
+	volatile struct time_page *tp =
+		(volatile struct time_page *)USER_TIME_PAGE;
+	u32 seq;
+
+	do {
+		seq = tp->seq;
+		l4_smp_mb();
+
+		*sec = tp->sec;
+		*usec = tp->usec;
+
+		l4_smp_mb();
+	} while ((seq & 1) || seq != tp->seq);
+}
@@ -0,0 +1,66 @@
+/*
+ * Reads kernel event trace rings mapped to a pager.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/trace.h>
+#include L4LIB_INC_ARCH(syscalls.h)
+#include L4LIB_INC_ARCH(barrier.h)
+#include <l4/api/container.h>
+
+/* Maps the trace ring of cpu read-only at page aligned vaddr */
+int l4_trace_map(int cpu, void *vaddr)
+{
+	return l4_container_control(CONTAINER_CONTROL_TRACE_MAP,
+				    cpu, vaddr);
+}
+
+/* Sets the event categories to record, returns the old set */
+int l4_trace_set_mask(u32 mask)
+{
+	return l4_container_control(CONTAINER_CONTROL_TRACE_MASK,
+				    mask, 0);
+}
+
+/*
+ * Copies out up to max events that were written since *tail,
+ * and advances *tail past them. Events the kernel overwrote
+ * before or during the copy are skipped. Returns the number
+ * of events copied.
+ */
+int l4_trace_read(volatile struct trace_buffer *tb, u32 *tail,
+		  struct trace_event *events, int max)
+{
+	u32 head = tb->head;
+	int count, lost;
+
+	l4_smp_mb();
+
+	/* Ring has wrapped past us since the last read */
+	if (head - *tail > TRACE_EVENTS)
+		*tail = head - TRACE_EVENTS;
+
+	count = head - *tail;
+	if (count > max)
+		count = max;
+
+	for (int i = 0; i < count; i++)
+		events[i] = tb->events[(*tail + i) & (TRACE_EVENTS - 1)];
+
+	l4_smp_mb();
+
+	/* Slots up to the one being written now are not reliable */
+	lost = (int)(tb->head - TRACE_EVENTS + 1 - *tail);
+	if (lost > count)
+		lost = count;
+	if (lost > 0) {
+		for (int i = lost; i < count; i++)
+			events[i - lost] = events[i];
+		count -= lost;
+		*tail += lost;
+	}
+
+	*tail += count;
+
+	return count;
+}
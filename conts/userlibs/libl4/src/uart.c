@@ -0,0 +1,59 @@
+/*
+ * Bulk send and receive over the uart service.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4lib/uart.h>
+#include <l4lib/ipcdefs.h>
+#include L4LIB_INC_ARCH(syslib.h)
+#include <l4/api/errno.h>
+#include <string.h>
+
+/*
+ * Sends up to UART_SENDBUF_MAX bytes in one ipc. Blocking sends
+ * return once all of buf is queued for transmit, nonblocking ones
+ * as soon as what fits is queued. Returns the bytes queued.
+ */
+int l4_uart_send(l4id_t uart, const void *buf, int size, unsigned int flags)
+{
+	int err;
+
+	if (size > UART_SENDBUF_MAX)
+		size = UART_SENDBUF_MAX;
+
+	memcpy(l4_get_utcb()->mr_rest, buf, size);
+
+	write_mr(L4SYS_ARG0, size);
+	write_mr(L4SYS_ARG1, flags);
+
+	if ((err = l4_sendrecv_full(uart, uart,
+				    L4_IPC_TAG_UART_SENDBUF)) < 0)
+		return err;
+
+	return l4_get_retval();
+}
+
+/*
+ * Receives up to UART_RECVBUF_MAX bytes of input in one ipc.
+ * Returns the bytes received.
+ */
+int l4_uart_recv(l4id_t uart, void *buf, int size, unsigned int flags,
+		 unsigned int timeout_ms)
+{
+	int err;
+
+	if (size > UART_RECVBUF_MAX)
+		size = UART_RECVBUF_MAX;
+
+	write_mr(L4SYS_ARG0, size);
+	write_mr(L4SYS_ARG1, flags);
+	write_mr(L4SYS_ARG2, timeout_ms);
+
+	/* Short request, and the data comes back as extended ipc */
+	if ((err = l4_sendrecv_extended(uart, uart,
+					L4_IPC_TAG_UART_RECVBUF,
+					L4SYS_ARG3, size, buf)) < 0)
+		return err;
+
+	return l4_get_retval();
+}
@@ -18,6 +18,7 @@ struct page_allocator {
 	struct link page_area_list;
 	struct link pga_cache_list;
 	int pga_free;
+	int pages_free;		/* Free pages left in all areas */
 };
 
 /* Initialises the page allocator */
@@ -26,5 +27,6 @@ void init_page_allocator(unsigned long start, unsigned long end);
 /* Page allocation functions */
 void *alloc_page(int quantity);
 int free_page(void *paddr);
+int free_page_count(void);
 
 #endif /* __ALLOC_PAGE_H__ */
@@ -51,6 +51,7 @@ get_free_page_area(int quantity, struct page_allocator *p)
 		/* Check for exact size match */
 		if (area->numpages == quantity && !area->used) {
 			area->used = 1;
+			p->pages_free -= quantity;
 			return area;
 		}
 
@@ -63,6 +64,7 @@ get_free_page_area(int quantity, struct page_allocator *p)
 			new->used = 1;
 			link_init(&new->list);
 			list_insert(&new->list, &area->list);
+			p->pages_free -= quantity;
 			return new;
 		}
 	}
@@ -123,8 +125,9 @@ void init_page_allocator(unsigned long start, unsigned long end)
 	/* Add it as the first unused page area */
 	list_insert(&freemem->list, &allocator.page_area_list);
 
-	/* Initialise free page area counter */
+	/* Initialise free page area and page counters */
 	allocator.pga_free = mem_cache_total_empty(cache);
+	allocator.pages_free = freemem->numpages;
 }
 
 /*
@@ -181,7 +184,8 @@ void *alloc_page(int quantity)
 	 * Now allocate the actual pages, using the available
 	 * page area structures to describe the allocation
 	 */
-	new = get_free_page_area(quantity, &allocator);
+	if (!(new = get_free_page_area(quantity, &allocator)))
+		return 0; /* Out of memory */
 
 	/* Return physical address */
 	return (void *)__pfn_to_addr(new->pfn);
@@ -225,6 +229,7 @@ static int find_and_free_page_area(void *addr, struct page_allocator *p)
 		if (__pfn_to_addr(area->pfn) == (unsigned long)addr &&
 		    area->used) {	/* Found it */
 			area->used = 0;
+			p->pages_free += area->numpages;
 			goto found;
 		}
 	return -1; /* Finished the loop, but area not found. */
@@ -249,3 +254,8 @@ int free_page(void *paddr)
 	return find_and_free_page_area(paddr, &allocator);
 }
 
+/* Number of pages alloc_page() can still hand out */
+int free_page_count(void)
+{
+	return allocator.pages_free;
+}
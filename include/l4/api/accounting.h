@@ -0,0 +1,98 @@
+/*
+ * Kernel operation counters and syscall timings,
+ * readable by pagers through sys_container_control().
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __API_ACCOUNTING_H__
+#define __API_ACCOUNTING_H__
+
+struct exception_count {
+	u64 syscall;
+	u64 data_abort;
+	u64 prefetch_abort;
+	u64 irq;
+	u64 undefined_abort;
+};
+
+/*
+ * Note these are packed to match systable offsets
+ * so that they're incremented with an auccess
+ */
+struct syscall_count {
+	u64 ipc;
+	u64 tswitch;
+	u64 tctrl;
+	u64 exregs;
+	u64 emtpy;
+	u64 unmap;
+	u64 irqctrl;
+	u64 empty1;
+	u64 map;
+	u64 getid;
+	u64 capctrl;
+	u64 empty2;
+	u64 time;
+	u64 mutexctrl;
+	u64 cachectrl;
+} __attribute__ ((__packed__));
+
+struct task_op_count {
+	u64 context_switch;
+	u64 space_switch;
+};
+
+struct cache_op_count {
+	u64 dcache_clean_mva;
+	u64 dcache_inval_mva;
+	u64 icache_clean_mva;
+	u64 icache_inval_mva;
+	u64 dcache_clean_setway;
+	u64 dcache_inval_setway;
+	u64 tlb_mva;
+};
+
+#if defined(CONFIG_DEBUG_PERFMON_KERNEL)
+
+/* Minimum, maximum and average timings for the call */
+struct syscall_timing {
+	u64 total;
+	u32 min;
+	u32 max;
+	u32 avg;
+};
+
+struct syscall_timings {
+	struct syscall_timing ipc;
+	struct syscall_timing tswitch;
+	struct syscall_timing tctrl;
+	struct syscall_timing exregs;
+	struct syscall_timing emtpy;
+	struct syscall_timing unmap;
+	struct syscall_timing irqctrl;
+	struct syscall_timing empty1;
+	struct syscall_timing map;
+	struct syscall_timing getid;
+	struct syscall_timing capctrl;
+	struct syscall_timing empty2;
+	struct syscall_timing time;
+	struct syscall_timing mutexctrl;
+	struct syscall_timing cachectrl;
+	u64 all_total;
+} __attribute__ ((__packed__));
+
+#endif /* End of CONFIG_DEBUG_PERFMON_KERNEL */
+
+struct system_accounting {
+	struct syscall_count syscalls;
+
+#if defined(CONFIG_DEBUG_PERFMON_KERNEL)
+	struct syscall_timings syscall_timings;
+#endif
+
+	struct exception_count exceptions;
+	struct cache_op_count cache_ops;
+	struct task_op_count task_ops;
+} __attribute__ ((__packed__));
+
+#endif /* __API_ACCOUNTING_H__ */
@@ -5,6 +5,14 @@
 #define IRQ_CONTROL_REGISTER		0
 #define IRQ_CONTROL_RELEASE		1
 #define IRQ_CONTROL_WAIT		2
+#define IRQ_CONTROL_ACK_WAIT		3
+
+/*
+ * Register flags. In batched mode the line stays masked after
+ * delivery until its thread acknowledges it with ACK_WAIT.
+ */
+#define IRQ_CONTROL_SLOT_MASK		0x000000FF
+#define IRQ_CONTROL_BATCHED		0x00000100
 
 
 #endif /* __API_IRQ_H__ */
@@ -73,8 +73,21 @@ struct kip {
 } __attribute__((__packed__));
 
 
+/*
+ * Time page, mapped read-only to every space next to the kip.
+ *
+ * The kernel increments seq before and after each update, so
+ * readers retry while seq is odd or has changed under them.
+ */
+struct time_page {
+	u32 seq;
+	u32 sec;	/* Seconds so far */
+	u32 usec;	/* Microseconds into this second */
+} __attribute__((__packed__));
+
 #if defined (__KERNEL__)
 extern struct kip kip;
+extern struct time_page time_page;
 #endif /* __KERNEL__ */
 
 
@@ -0,0 +1,58 @@
+#ifndef __API_TRACE_H__
+#define __API_TRACE_H__
+
+/* Event categories, each enabled by its bit in the trace mask */
+#define TRACE_CAT_SYSCALL		0
+#define TRACE_CAT_IPC			1
+#define TRACE_CAT_SCHED			2
+#define TRACE_CAT_PFAULT		3
+#define TRACE_CAT_IRQ			4
+#define TRACE_CAT_MUTEX			5
+
+#define TRACE_MASK(cat)			(1 << (cat))
+#define TRACE_MASK_ALL			0x3F
+
+/* Event types carry their category in the upper byte */
+#define TRACE_TYPE(cat, n)		(((cat) << 8) | (n))
+#define TRACE_TYPE_CAT(type)		((type) >> 8)
+
+#define TRACE_SYSCALL_ENTER	TRACE_TYPE(TRACE_CAT_SYSCALL, 0) /* Syscall offset */
+#define TRACE_SYSCALL_EXIT	TRACE_TYPE(TRACE_CAT_SYSCALL, 1) /* Return value */
+#define TRACE_IPC_SEND		TRACE_TYPE(TRACE_CAT_IPC, 0)	 /* Receiver */
+#define TRACE_IPC_RECV		TRACE_TYPE(TRACE_CAT_IPC, 1)	 /* Expected sender */
+#define TRACE_SCHED_SWITCH	TRACE_TYPE(TRACE_CAT_SCHED, 0)	 /* Next thread */
+#define TRACE_PFAULT_IPC	TRACE_TYPE(TRACE_CAT_PFAULT, 0)	 /* Fault address */
+#define TRACE_IRQ_ENTER		TRACE_TYPE(TRACE_CAT_IRQ, 0)	 /* Irq number */
+#define TRACE_IRQ_EXIT		TRACE_TYPE(TRACE_CAT_IRQ, 1)	 /* Irq number */
+#define TRACE_MUTEX_WAIT	TRACE_TYPE(TRACE_CAT_MUTEX, 0)	 /* Mutex address */
+#define TRACE_MUTEX_WOKEN	TRACE_TYPE(TRACE_CAT_MUTEX, 1)	 /* Mutex address */
+
+#define TRACE_MAGIC			0x31435254	/* "TRC1" */
+#define TRACE_EVENTS			1024		/* Power of two */
+
+struct trace_event {
+	u32 stamp;	/* Clock source count */
+	u32 type;
+	u32 tid;	/* Thread current at the event */
+	u32 arg;
+};
+
+/*
+ * A per-cpu trace ring, mapped read-only to pagers on request.
+ *
+ * head counts all events written so far, the last of which is at
+ * events[(head - 1) % TRACE_EVENTS]. The kernel never waits for
+ * readers, so readers check head again after copying events out,
+ * and drop those that may have been overwritten in between.
+ */
+struct trace_buffer {
+	u32 magic;
+	u32 cpu;
+	u32 head;
+	u32 mask;	/* Enabled categories */
+	u32 clock_hz;	/* Rate of event stamps */
+	u32 reserved[3];
+	struct trace_event events[TRACE_EVENTS];
+};
+
+#endif /* __API_TRACE_H__ */
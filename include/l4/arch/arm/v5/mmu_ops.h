@@ -22,9 +22,13 @@ void arm_clean_dcache(void);
 void arm_clean_invalidate_dcache(void);
 void arm_clean_invalidate_cache(void);
 void arm_drain_writebuffer(void);
+void arm_wait_for_interrupt(void);
 void arm_invalidate_tlb(void);
 void arm_invalidate_itlb(void);
 void arm_invalidate_dtlb(void);
+void arm_clean_invalidate_dcache_page(unsigned long vaddr);
+void arm_clean_dcache_line(unsigned long vaddr);
+void arm_invalidate_tlb_page(unsigned long vaddr);
 
 static inline void arm_enable_caches(void)
 {
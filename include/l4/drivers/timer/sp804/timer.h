@@ -36,11 +36,17 @@
 
 unsigned long timer_secondary_base(unsigned long timer_base);
 void timer_irq_clear(unsigned long timer_base);
+int timer_irq_raw(unsigned long timer_base);
 void timer_start(unsigned long timer_base);
 void timer_load(u32 loadval, unsigned long timer_base);
 u32 timer_read(unsigned long timer_base);
 void timer_stop(unsigned long timer_base);
 void timer_init_periodic(unsigned long timer_base, unsigned int load_value);
+void timer_init_periodic_phase(unsigned long timer_base,
+			       unsigned int load_value,
+			       unsigned int first_value);
 void timer_init_oneshot(unsigned long timer_base);
+void timer_init_freerunning(unsigned long timer_base);
+void timer_start_oneshot(unsigned long timer_base, unsigned int load_value);
 void timer_init(unsigned long timer_base, unsigned int load_value);
 #endif /* __SP804_TIMER_H__ */
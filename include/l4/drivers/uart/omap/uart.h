@@ -55,6 +55,7 @@
 #define OMAP_UART_BANKED_MODE_CONFIG_B         0xBF
 
 void uart_tx_char(unsigned long base, char c);
+int uart_tx_full(unsigned long uart_base);
 char uart_rx_char(unsigned long uart_base);
 void uart_set_baudrate(unsigned long uart_base, u32 baudrate, u32 clkrate);
 void uart_init(unsigned long uart_base);
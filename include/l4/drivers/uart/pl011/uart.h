@@ -27,6 +27,7 @@
 
 
 void uart_tx_char(unsigned long uart_base, char c);
+int uart_tx_full(unsigned long uart_base);
 char uart_rx_char(unsigned long uart_base);
 void uart_init(unsigned long base);
 
@@ -103,6 +103,7 @@
 #define CAP_IPC_FULL		(1 << 3)
 #define CAP_IPC_EXTENDED	(1 << 4)
 #define CAP_IPC_ASYNC		(1 << 5)
+#define CAP_IPC_LONG		(1 << 6)
 
 /* Userspace mutex capability */
 #define CAP_UMUTEX_LOCK		(1 << 0)
@@ -21,67 +21,77 @@
 #define CAP_RESID_NONE		-1
 
 
+/* Capability types are single bits in CAP_TYPE_MASK */
+#define CAP_TYPE_TOTAL		16
+
+/*
+ * Capabilities of a list are kept grouped by type, with
+ * a reference to where each group starts so that lookups
+ * only visit caps of the type they need. Within a group
+ * caps are in order of their start, which lets memory
+ * lookups stop at the first cap that starts beyond them.
+ *
+ * Kernel pool caps have no type, they are kept in the
+ * extra group at the end.
+ */
 struct cap_list {
 	int ncaps;
 	struct link caps;
+	struct capability *type_first[CAP_TYPE_TOTAL + 1];
 };
 
 void capability_init(struct capability *cap);
 
-static inline void cap_list_init(struct cap_list *clist)
+static inline int cap_type_index(unsigned int type)
 {
-	clist->ncaps = 0;
-	link_init(&clist->caps);
-}
+	int index = 0;
 
-static inline void cap_list_insert(struct capability *cap,
-				   struct cap_list *clist)
-{
-	list_insert(&cap->list, &clist->caps);
-	clist->ncaps++;
+	while (!(type & 1) && index < CAP_TYPE_TOTAL) {
+		type >>= 1;
+		index++;
+	}
+	return index;
 }
 
-static inline void cap_list_remove(struct capability *cap,
-				   struct cap_list *clist)
+static inline void cap_list_init(struct cap_list *clist)
 {
-	list_remove(&cap->list);
-	clist->ncaps--;
+	clist->ncaps = 0;
+	link_init(&clist->caps);
+	for (int i = 0; i <= CAP_TYPE_TOTAL; i++)
+		clist->type_first[i] = 0;
 }
 
-/* Detach a whole list of capabilities from list head */
-static inline struct capability *
-cap_list_detach(struct cap_list *clist)
-{
-	struct link *list;
+void cap_list_insert(struct capability *cap, struct cap_list *clist);
+void cap_list_remove(struct capability *cap, struct cap_list *clist);
+void cap_list_move(struct cap_list *to, struct cap_list *from);
 
-	if (!clist->ncaps)
-		return 0;
+/*
+ * Changed on any change to capability lists or to the
+ * ranges of caps in them. Threads cache the caps that
+ * last matched their checks, which are only valid for
+ * the generation they were matched in.
+ */
+extern unsigned int cap_generation;
 
-	list = list_detach(&clist->caps);
-	clist->ncaps = 0;
-	return link_to_struct(list, struct capability, list);
+static inline void cap_generation_bump(void)
+{
+	cap_generation++;
 }
 
-/* Attach a whole list of capabilities to list head */
-static inline void cap_list_attach(struct capability *cap,
-				   struct cap_list *clist)
-{
-	/* Attach as if cap is the list and clist is the element */
-	list_insert(&clist->caps, &cap->list);
+#define CAP_CACHE_SIZE		4
 
-	/* Count the number of caps attached */
-	list_foreach_struct(cap, &clist->caps, list)
-		clist->ncaps++;
-}
+struct cap_cache {
+	unsigned int generation;
+	int next;		/* Entry to replace next */
+	struct capability *cap[CAP_CACHE_SIZE];
+};
 
-static inline void cap_list_move(struct cap_list *to,
-				 struct cap_list *from)
+static inline void cap_cache_flush(struct cap_cache *cache)
 {
-	if (!from->ncaps)
-		return;
-
-	struct capability *cap_head = cap_list_detach(from);
-	cap_list_attach(cap_head, to);
+	for (int i = 0; i < CAP_CACHE_SIZE; i++)
+		cache->cap[i] = 0;
+	cache->generation = cap_generation;
+	cache->next = 0;
 }
 
 /* Have to have these as tcb.h includes this file */
@@ -100,6 +110,9 @@ struct capability *cap_list_find_by_rtype(struct cap_list *clist,
 /* Capability checking on systm calls */
 int cap_map_check(struct ktcb *task, unsigned long phys, unsigned long virt,
 		  unsigned long npages, unsigned int flags);
+int cap_map_item_check(struct ktcb *from, struct ktcb *to,
+		       unsigned long phys, unsigned long virt,
+		       unsigned long npages, unsigned int flags);
 int cap_unmap_check(struct ktcb *task, unsigned long virt,
 		    unsigned long npages);
 int cap_thread_check(struct ktcb *task, unsigned int flags,
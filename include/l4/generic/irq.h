@@ -11,6 +11,7 @@
 #include <l4/lib/printk.h>
 #include INC_PLAT(irq.h)
 #include INC_ARCH(types.h)
+#include <l4/api/container.h>
 
 /* Represents none or spurious irq */
 #define IRQ_NIL				0xFFFFFFFF /* -1 */
@@ -19,6 +20,10 @@
 /* Successful irq handling state */
 #define IRQ_HANDLED				0
 
+/* Irq descriptor flags */
+#define IRQ_DESC_BATCHED			(1 << 0)	/* Masked until acknowledged */
+#define IRQ_DESC_MASKED				(1 << 1)	/* Delivered, awaiting ack */
+
 typedef void (*irq_op_t)(l4id_t irq);
 struct irq_chip_ops {
 	void (*init)();
@@ -50,9 +55,18 @@ struct irq_desc {
 	/* Notification slot for this irq */
 	int task_notify_slot;
 
+	/* Delivery mode and state */
+	unsigned int flags;
+
 	/* Waitqueue head for this irq */
 	struct waitqueue_head wqh_irq;
 
+#if defined(CONFIG_DEBUG_IRQ_LATENCY)
+	/* Clock count at the oldest unserviced delivery, 0 if none */
+	u32 latency_stamp;
+	struct irq_latency_stats latency;
+#endif
+
 	/* NOTE: This could be a list for multiple handlers for shared irqs */
 	irq_handler_t handler;
 };
@@ -85,6 +99,17 @@ static inline void irq_set_cpu(int irq_index, unsigned int cpumask)
 
 int irq_register(struct ktcb *task, int notify_slot, l4id_t irq_index);
 int irq_thread_notify(struct irq_desc *desc);
+int irq_ack_lines(struct ktcb *task);
+u32 irq_task_slots(struct ktcb *task);
+int irq_release(struct ktcb *task, l4id_t irq_index);
+void irq_release_all(struct ktcb *task);
+
+#if defined(CONFIG_DEBUG_IRQ_LATENCY)
+void irq_latency_scheduled(struct ktcb *task);
+int irq_latency_read(unsigned int flags, void *userbuf);
+#else
+static inline void irq_latency_scheduled(struct ktcb *task) { }
+#endif
 
 void do_irq(void);
 void irq_controllers_init(void);
@@ -0,0 +1,22 @@
+/*
+ * Asynchronous notification bits
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __GENERIC_NOTIFY_H__
+#define __GENERIC_NOTIFY_H__
+
+struct ktcb;
+
+void notify_signal(struct ktcb *task, u32 bits);
+int notify_wait(u32 mask, u32 *bits);
+int notify_wait_timeout(u32 mask, u32 *bits, u32 ticks);
+
+/* Timeouts of notification waits, run by the timer cpu */
+void notify_timer_cancel(struct ktcb *task);
+void notify_timer_run(void);
+u32 notify_timer_next(void);
+int ipc_signal(l4id_t to, unsigned int flags);
+int ipc_signal_wait(unsigned int flags);
+
+#endif /* __GENERIC_NOTIFY_H__ */
@@ -71,9 +71,13 @@ struct scheduler {
 	struct runqueue *rq_expired;
 
 	struct ktcb *idle_task;
+	struct ktcb *running;	/* Task that is running on this cpu */
 
 	/* Total priority of all tasks in container */
 	int prio_total;
+
+	/* Mask of cpus short of work, asking for a task */
+	volatile unsigned int balance_request;
 };
 
 DECLARE_PERCPU(extern struct scheduler, scheduler);
@@ -86,6 +90,15 @@ void sched_suspend_async(void);
 void sched_resume_sync(struct ktcb *task);
 void sched_resume_async(struct ktcb *task);
 void sched_enqueue_task(struct ktcb *first_time_runner, int sync);
+int sched_has_runnable(void);
+
+#if defined (CONFIG_SMP_)
+void sched_balance_tick(void);
+void sched_balance_idle(void);
+#else
+static inline void sched_balance_tick(void) { }
+static inline void sched_balance_idle(void) { }
+#endif
 void scheduler_start(void);
 void schedule(void);
 void sched_init(void);
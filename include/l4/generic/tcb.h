@@ -118,8 +118,8 @@ struct ktcb {
 	unsigned long utcb_address;	/* Virtual ref to task's utcb area */
 
 	/* Thread times */
-	u32 kernel_time;	/* Ticks spent in kernel */
-	u32 user_time;		/* Ticks spent in userland */
+	u64 kernel_time;	/* Clock counts spent in kernel */
+	u64 user_time;		/* Clock counts spent in userland */
 	u32 ticks_left;		/* Timeslice ticks left for reschedule */
 	u32 ticks_assigned;	/* Ticks assigned to this task on this HZ */
 	u32 sched_granule;	/* Granularity ticks left for reschedule */
@@ -137,6 +137,9 @@ struct ktcb {
 	/* Container */
 	struct container *container;
 
+	/* Capabilities that recently passed checks of this thread */
+	struct cap_cache cap_cache;
+
 	/* Other related threads */
 	struct ktcb *pager;
 	int nchild;
@@ -149,6 +152,27 @@ struct ktcb {
 	/* Waitqueue for notifiactions */
 	struct waitqueue_head wqh_notify;
 
+	/* Pending notification bits, and those being waited on */
+	u32 notify_bits;
+	u32 notify_wait_mask;
+
+	/*
+	 * Irq slots delivered to us, and those being waited on. These
+	 * are kept apart from notify_bits, which any peer may raise.
+	 */
+	u32 irq_bits;
+	u32 irq_wait_mask;
+
+	/* Timeout of a notification wait, see notify_wait_timeout() */
+	struct link notify_timer;
+	u32 notify_timer_expiry;	/* In jiffies */
+	int notify_timed_out;
+
+#if defined(CONFIG_DEBUG_IRQ_LATENCY)
+	/* An irq registered to us was stamped, see irq_latency_scheduled() */
+	int irq_latency_pending;
+#endif
+
 	/* Waitqueue for pagers to wait for task states */
 	struct waitqueue_head wqh_pager;
 
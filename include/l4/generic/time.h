@@ -15,7 +15,40 @@ struct timeval {
 
 extern volatile u32 jiffies;
 
+/*
+ * A free running counter that system time is kept by.
+ * Platforms register one that is finer than the tick.
+ */
+struct clocksource {
+	char *name;
+	u32 (*read)(void);	/* Returns an incrementing count */
+	u32 freq;		/* Count frequency in Hz */
+	u64 mult;		/* Count to shifted usec multiplier */
+};
+
+void clocksource_register(struct clocksource *cs);
+u32 clocksource_read(void);
+u32 clocksource_freq(void);
+void update_system_time(void);
+
+/* Charge clock counts since last call to current thread */
+void account_user_time(void);
+void account_kernel_time(void);
+u64 cputime_to_usec(u64 counts);
+
 int do_timer_irq(void);
 int secondary_timer_irq(void);
 
+#if defined (CONFIG_SCHED_TICKLESS)
+
+void tick_nohz_idle_enter(void);
+void tick_nohz_idle_exit(void);
+
+#else /* End of CONFIG_SCHED_TICKLESS */
+
+static inline void tick_nohz_idle_enter(void) { }
+static inline void tick_nohz_idle_exit(void) { }
+
+#endif /* End of !CONFIG_SCHED_TICKLESS */
+
 #endif /* __GENERIC_TIME_H__ */
@@ -0,0 +1,36 @@
+/*
+ * Kernel event tracing definitions.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#ifndef __GENERIC_TRACE_H__
+#define __GENERIC_TRACE_H__
+
+#include INC_ARCH(types.h)
+#include <l4/api/trace.h>
+
+#if defined(CONFIG_DEBUG_TRACE)
+
+/* Categories enabled on all cpus, none until a pager asks */
+extern u32 trace_mask;
+
+void trace_event(unsigned int type, u32 arg);
+void trace_init(void);
+int trace_map(unsigned int cpu, unsigned long vaddr);
+u32 trace_set_mask(u32 mask);
+
+/* Disabled categories cost a load and a branch */
+static inline void trace(unsigned int type, u32 arg)
+{
+	if (trace_mask & TRACE_MASK(TRACE_TYPE_CAT(type)))
+		trace_event(type, arg);
+}
+
+#else /* End of CONFIG_DEBUG_TRACE */
+
+static inline void trace(unsigned int type, u32 arg) { }
+static inline void trace_init(void) { }
+
+#endif /* End of !CONFIG_DEBUG_TRACE */
+
+#endif /* __GENERIC_TRACE_H__ */
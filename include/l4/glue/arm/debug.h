@@ -13,12 +13,10 @@
 
 #if defined (CONFIG_DEBUG_ACCOUNTING)
 
-extern struct system_accounting system_accounting;
-
 static inline void
 system_account_syscall_type(unsigned long swi_address)
 {
-	*(((u64 *)&system_accounting.syscalls) +
+	*(((u64 *)&per_cpu(system_accounting).syscalls) +
 				  ((swi_address & 0xFF) >> 2)) += 1;
 }
 
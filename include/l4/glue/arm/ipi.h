@@ -12,5 +12,6 @@ int ipi_handler(struct irq_desc *desc);
 
 
 #define IPI_TIMER_EVENT		0
+#define IPI_RESCHEDULE		1
 
 #endif	/* __IPI_H__ */
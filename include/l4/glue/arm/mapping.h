@@ -45,6 +45,9 @@ int check_mapping_pgd(unsigned long vaddr, unsigned long size,
 int check_mapping(unsigned long vaddr, unsigned long size,
 		  unsigned int flags);
 
+int check_mapping_cache_pgd(unsigned long vaddr, unsigned long size,
+			    unsigned int flags, pgd_table_t *pgd);
+
 void copy_pgd_kern_all(pgd_table_t *);
 
 struct address_space;
@@ -92,6 +95,11 @@ void arch_space_switch(struct ktcb *task);
 
 int pgd_count_boot_pmds();
 
+void copy_window_init(void);
+unsigned long copy_window_map(struct ktcb *task, unsigned long vaddr,
+			      unsigned int flags);
+void copy_window_unmap(void);
+
 void idle_task(void);
 
 #endif /* __ARM_GLUE_MAPPING_H__ */
@@ -23,6 +23,7 @@
 #define IO_AREA_SECTIONS	(IO_AREA_SIZE / ARM_SECTION_SIZE)
 
 #define USER_KIP_PAGE		0xFF000000
+#define USER_TIME_PAGE		0xFF001000
 
 /* ARM-specific offset in KIP that tells the address of UTCB page */
 #define UTCB_KIP_OFFSET		0x50
@@ -41,6 +42,13 @@
  * The beginning page in this slot is used for userspace uart mapping
  */
 
+/*
+ * Last slot of the io area holds one copy window page per cpu.
+ * Long ipc maps pages of a non-running task here to reach them.
+ */
+#define COPY_WINDOW_AREA	(IO_AREA_END - SZ_1MB)
+#define COPY_WINDOW_VADDR(cpu)	(COPY_WINDOW_AREA + ((cpu) * PAGE_SIZE))
+
 #define ARM_HIGH_VECTOR		0xFFFF0000
 #define ARM_SYSCALL_VECTOR	0xFFFFFF00
 
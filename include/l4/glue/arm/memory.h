@@ -74,6 +74,15 @@ static inline void be32_to_cpu(unsigned int x)
 	p[2] = tmp;
 }
 
+/*
+ * Copy and clear of cache line aligned memory, in multiples of 64
+ * bytes, with loops tuned for the subarch. See src/arch/arm/page.S
+ */
+void copy_blocks(void *to, const void *from, unsigned long size);
+void clear_blocks(void *to, unsigned long size);
+void copy_page(void *to, const void *from);
+void clear_page(void *to);
+
 struct ktcb;
 void task_init_registers(struct ktcb *task, unsigned long pc);
 
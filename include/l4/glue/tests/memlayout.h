@@ -64,6 +64,9 @@
 /* First page in MISC area is used for KIP/UTCB reference page */
 #define USER_KIP_PAGE		MISC_AREA_START
 
+/* Second page holds the time page */
+#define USER_TIME_PAGE		(MISC_AREA_START + 0x1000)
+
 /* 0xfff00000 */
 #define EXCPT_AREA_START	0xFFF00000
 #define EXCPT_AREA_END		(EXCPT_AREA_START + ARM_SECTION_SIZE)
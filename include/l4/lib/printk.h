@@ -10,6 +10,15 @@
 int printk(char *format, ...) __attribute__((format (printf, 1, 2)));
 extern void putc(char c);
 void init_printk_lock(void);
+
+#if defined(CONFIG_PRINTK_ASYNC)
+void printk_async_start(void);
+int printk_drain(void);
+int printk_log_read(unsigned int flags, void *userbuf);
+#else
+static inline void printk_async_start(void) { }
+static inline int printk_drain(void) { return 0; }
+#endif
 #endif
 
 #endif /* __PRINTK_H__ */
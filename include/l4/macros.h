@@ -113,8 +113,21 @@ static inline int is_err(int x)
 }
 #endif
 
+/*
+ * Kernel console output may be buffered, in which case the kernel
+ * provides printk_panic() to flush it and print synchronously. It
+ * is weak as others build with this header and __KERNEL__ too.
+ */
+#if defined(__KERNEL__) && !defined(__ASSEMBLY__)
+void printk_panic(void) __attribute__((weak));
+#define printk_sync()		do { if (printk_panic) printk_panic(); } while (0)
+#else
+#define printk_sync()		do { } while (0)
+#endif
+
 /* TEST: Is this type of printk well tested? */
 #define BUG()			{do {								\
+					printk_sync();					\
 					printk("BUG in file: %s function: %s line: %d\n",	\
 						__FILE__, __FUNCTION__, __LINE__);		\
 				} while(0);							\
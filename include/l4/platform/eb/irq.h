@@ -81,12 +81,14 @@
 #define IRQ_TIMER1	MPCORE_GIC_IRQ_TIMER23
 #define IRQ_KEYBOARD0   MPCORE_GIC_IRQ_KMI0
 #define IRQ_MOUSE0	MPCORE_GIC_IRQ_KMI1
+#define IRQ_UART1	MPCORE_GIC_IRQ_UART1
 #define IRQ_CLCD0	MPCORE_GIC_IRQ_CLCD
 #else
 #define IRQ_TIMER0	EB_IRQ_TIMER01
 #define IRQ_TIMER1	EB_IRQ_TIMER23
 #define IRQ_KEYBOARD0	EB_IRQ_KMI0
 #define IRQ_MOUSE0	EB_IRQ_KMI1
+#define IRQ_UART1	EB_IRQ_UART1
 #define IRQ_CLCD0	EB_IRQ_CLCD
 #endif
 
@@ -9,5 +9,7 @@
 #define __PB926_PLATFORM_H__
 
 void platform_timer_start(void);
+void platform_timer_oneshot(unsigned int ticks);
+unsigned int platform_timer_periodic(void);
 
 #endif /* __PB926_PLATFORM_H__ */
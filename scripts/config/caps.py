@@ -13,7 +13,8 @@ cap_strings = { 'ipc' : \
 \t\t\t\t.type = CAP_TYPE_IPC | ${target_rtype},
 \t\t\t\t.access = CAP_IPC_SEND | CAP_IPC_RECV
 \t\t\t\t          | CAP_IPC_FULL | CAP_IPC_SHORT
-\t\t\t\t          | CAP_IPC_EXTENDED | CAP_CHANGEABLE
+\t\t\t\t          | CAP_IPC_EXTENDED | CAP_IPC_LONG
+\t\t\t\t          | CAP_IPC_ASYNC | CAP_CHANGEABLE
 \t\t\t\t          | CAP_REPLICABLE | CAP_TRANSFERABLE,
 \t\t\t\t.start = 0, .end = 0, .size = 0,
 \t\t\t},
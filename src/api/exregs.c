@@ -7,6 +7,7 @@
 #include <l4/generic/space.h>
 #include <l4/generic/capability.h>
 #include <l4/generic/container.h>
+#include <l4/generic/time.h>
 #include <l4/api/ipc.h>
 #include <l4/api/kip.h>
 #include <l4/api/errno.h>
@@ -123,6 +124,12 @@ flags:
 	/* Read thread's utcb if utcb flag supplied */
 	if (exregs->flags & EXREGS_SET_UTCB)
 		exregs->utcb_address = task->utcb_address;
+
+	/* Read thread's cpu times if cputime flag supplied */
+	if (exregs->flags & EXREGS_CPUTIME) {
+		exregs->user_time = cputime_to_usec(task->user_time);
+		exregs->kernel_time = cputime_to_usec(task->kernel_time);
+	}
 }
 
 /*
@@ -184,8 +191,10 @@ int sys_exchange_registers(struct exregs_data *exregs, l4id_t tid)
 		goto out;
 	}
 
-	if ((err = cap_exregs_check(task, exregs)) < 0)
-		return -ENOCAP;
+	if ((err = cap_exregs_check(task, exregs)) < 0) {
+		err = -ENOCAP;
+		goto out;
+	}
 
 	/* Copy registers */
 	if (exregs->flags & EXREGS_READ)
@@ -11,9 +11,15 @@
 #include <l4/api/errno.h>
 #include <l4/lib/bit.h>
 #include <l4/lib/math.h>
+#include <l4/generic/preempt.h>
+#include <l4/generic/notify.h>
+#include <l4/generic/trace.h>
+#include <l4/lib/wait.h>
 #include INC_API(syscall.h)
 #include INC_GLUE(message.h)
 #include INC_GLUE(ipc.h)
+#include INC_GLUE(mapping.h)
+#include INC_ARCH(irq.h)
 
 int ipc_short_copy(struct ktcb *to, struct ktcb *from)
 {
@@ -72,6 +78,205 @@ int ipc_extended_copy(struct ktcb *to, struct ktcb *from)
 	return 0;
 }
 
+/*
+ * Long copy goes directly from the sender's user buffer to the
+ * receiver's. The buffer of the party that is running is accessed
+ * in place, while the pages of the sleeping party are reached one
+ * at a time through the per-cpu copy window. Threads of one space
+ * have both buffers live, so they need no window. Both buffers have
+ * been faulted in by their owners before engaging in ipc.
+ */
+int ipc_long_copy(struct ktcb *to, struct ktcb *from)
+{
+	unsigned int *mr0_src = KTCB_REF_MR0(from);
+	unsigned int *mr0_dst = KTCB_REF_MR0(to);
+	int from_index = extended_ipc_msg_index(from->ipc_flags);
+	int to_index = extended_ipc_msg_index(to->ipc_flags);
+	unsigned long src = mr0_src[from_index];
+	unsigned long dst = mr0_dst[to_index];
+	unsigned long size = min(mr0_src[from_index + 1],
+				 mr0_dst[to_index + 1]);
+	unsigned long copied = 0, chunk, window;
+	int ret;
+
+	BUG_ON(to != current && from != current);
+
+	if (to->space == from->space) {
+		if (!check_mapping(src, size, MAP_USR_RO) ||
+		    !check_mapping(dst, size, MAP_USR_RW))
+			return -EFAULT;
+		memcpy((void *)dst, (void *)src, size);
+		src += size;
+		dst += size;
+		copied = size;
+	}
+
+	while (copied < size) {
+		/* Copy up to the end of the page seen through the window */
+		if (to == current)
+			chunk = min(size - copied,
+				    PAGE_SIZE - (src & PAGE_MASK));
+		else
+			chunk = min(size - copied,
+				    PAGE_SIZE - (dst & PAGE_MASK));
+
+		preempt_disable();
+		if (to == current) {
+			if (!check_mapping(dst, chunk, MAP_USR_RW) ||
+			    !(window = copy_window_map(from, src,
+						       MAP_USR_RO))) {
+				preempt_enable();
+				return -EFAULT;
+			}
+			memcpy((void *)dst, (void *)window, chunk);
+		} else {
+			if (!check_mapping(src, chunk, MAP_USR_RO) ||
+			    !(window = copy_window_map(to, dst,
+						       MAP_USR_RW))) {
+				preempt_enable();
+				return -EFAULT;
+			}
+			memcpy((void *)window, (void *)src, chunk);
+		}
+		copy_window_unmap();
+		preempt_enable();
+
+		src += chunk;
+		dst += chunk;
+		copied += chunk;
+	}
+
+	/* Primary registers travel as in a short ipc */
+	if ((ret = ipc_short_copy(to, from)) < 0)
+		return ret;
+
+	/* Receiver gets back its buffer and the transferred size */
+	mr0_dst[to_index] = dst - copied;
+	mr0_dst[to_index + 1] = copied;
+
+	return 0;
+}
+
+/* Converts flexpage access rights to user map flags */
+static inline unsigned int fpage_map_flags(unsigned int fpage)
+{
+	if (fpage & L4_FPAGE_UNCACHED)
+		return MAP_USR_IO;
+
+	switch (fpage & (L4_FPAGE_WRITE | L4_FPAGE_EXEC)) {
+	case L4_FPAGE_WRITE | L4_FPAGE_EXEC:
+		return MAP_USR_RWX;
+	case L4_FPAGE_WRITE:
+		return MAP_USR_RW;
+	case L4_FPAGE_EXEC:
+		return MAP_USR_RX;
+	default:
+		return MAP_USR_RO;
+	}
+}
+
+/*
+ * Checks every page of the sender's item before anything is
+ * mapped, so that a refused item leaves both spaces as they were.
+ * Each page must be mapped in the sender with the rights it passes
+ * on and with the same cache attributes, the sender must have a
+ * physmem capability for it, and the receiver a virtmem capability
+ * for the window it is mapped to.
+ */
+static int ipc_map_check(struct ktcb *to, struct ktcb *from,
+			 unsigned long src, unsigned long dst,
+			 unsigned long size, unsigned int map_flags)
+{
+	unsigned long phys;
+
+	for (unsigned long offset = 0; offset < size; offset += PAGE_SIZE) {
+		if (!check_mapping_pgd(src + offset, PAGE_SIZE,
+				       map_flags, TASK_PGD(from)) ||
+		    !check_mapping_cache_pgd(src + offset, PAGE_SIZE,
+					     map_flags, TASK_PGD(from)))
+			return -EFAULT;
+
+		phys = virt_to_phys_by_pgd(TASK_PGD(from), src + offset);
+
+		if (cap_map_item_check(from, to, phys, dst + offset,
+				       1, map_flags) < 0)
+			return -ENOIPC;
+
+		/* Pages of the receiver are neither replaced nor undone */
+		if (virt_to_pte_from_pgd(TASK_PGD(to), dst + offset))
+			return -ENOIPC;
+	}
+
+	return 0;
+}
+
+/*
+ * Installs the pages of the sender's map or grant item into the
+ * receive window, up to the smaller of the two flexpages. A grant
+ * also removes the pages from the sender, once all of them are
+ * in place. Page tables are charged to the receiver, and if they
+ * run out the pages installed so far are taken out again. As the
+ * window must be unmapped, these are only ever pages of this item,
+ * never ones the receiver had in place before. Refused items
+ * fail with -ENOIPC, as that is what the sleeping party can be
+ * told.
+ */
+int ipc_map_copy(struct ktcb *to, struct ktcb *from,
+		 unsigned int recv_fpage, unsigned int *received)
+{
+	int from_index = extended_ipc_msg_index(from->ipc_flags);
+	unsigned int send_fpage = KTCB_REF_MR0(from)[from_index];
+	unsigned int order = min(send_fpage & L4_FPAGE_ORDER_MASK,
+				 recv_fpage & L4_FPAGE_ORDER_MASK);
+	unsigned int map_flags = fpage_map_flags(send_fpage);
+	unsigned long src = page_align(send_fpage);
+	unsigned long dst = page_align(recv_fpage);
+	unsigned long size = 1UL << order;
+	unsigned long offset;
+	int ret;
+
+	if ((ret = ipc_map_check(to, from, src, dst, size, map_flags)) < 0)
+		return ret;
+
+	for (offset = 0; offset < size; offset += PAGE_SIZE) {
+		if (add_mapping_use_cap(virt_to_phys_by_pgd(TASK_PGD(from),
+							    src + offset),
+					dst + offset, PAGE_SIZE, map_flags,
+					to->space, &to->space->cap_list) < 0)
+			goto undo;
+	}
+
+	if (tcb_get_ipc_flags(from) & IPC_FLAGS_GRANT)
+		for (offset = 0; offset < size; offset += PAGE_SIZE)
+			remove_mapping_space(from->space, src + offset);
+
+	*received = dst | order | (send_fpage & L4_FPAGE_ATTR_MASK);
+
+	return 0;
+
+undo:
+	while (offset) {
+		offset -= PAGE_SIZE;
+		remove_mapping_space(to->space, dst + offset);
+	}
+	return -ENOIPC;
+}
+
+/* Whether a receive of type recv accepts a send of type send */
+static inline int ipc_types_match(unsigned int recv, unsigned int send)
+{
+	switch (recv) {
+	case IPC_FLAGS_SHORT:
+	case IPC_FLAGS_FULL:
+		return send == IPC_FLAGS_SHORT || send == IPC_FLAGS_FULL;
+	case IPC_FLAGS_EXTENDED:
+	case IPC_FLAGS_LONG:
+		return send == recv;
+	default:
+		return 0;
+	}
+}
+
 /*
  * Copies message registers from one ktcb stack to another. During the return
  * from system call, the registers are popped from the stack. In the future
@@ -85,7 +290,9 @@ int ipc_msg_copy(struct ktcb *to, struct ktcb *from)
 {
 	unsigned int recv_ipc_type;
 	unsigned int send_ipc_type;
-	unsigned int *mr0_dst;
+	unsigned int *mr0_dst = KTCB_REF_MR0(to);
+	int window_index = extended_ipc_msg_index(to->ipc_flags) + 1;
+	unsigned int window = 0, received = 0;
 	int ret = 0;
 
        	recv_ipc_type = tcb_get_ipc_type(to);
@@ -99,42 +306,54 @@ int ipc_msg_copy(struct ktcb *to, struct ktcb *from)
 	 * FULL		FULL/SHORT	-> FULL IPC
 	 * EXTENDED	EXTENDED	-> EXTENDED IPC
 	 * EXTENDED	NON-EXTENDED	-> ENOIPC
+	 * LONG		LONG		-> LONG IPC
+	 * LONG		NON-LONG	-> ENOIPC
+	 *
+	 * A mismatch is refused before anything is copied or mapped.
 	 */
+	if (!ipc_types_match(recv_ipc_type, send_ipc_type))
+		return -ENOIPC;
+
+	/* An item needs a receiver that is willing to take pages */
+	if ((tcb_get_ipc_flags(from) & IPC_FLAGS_ITEM_MASK) &&
+	    !(tcb_get_ipc_flags(to) & IPC_FLAGS_WINDOW))
+		return -ENOIPC;
+
+	/* The message overwrites the window, so note it first */
+	if (tcb_get_ipc_flags(to) & IPC_FLAGS_WINDOW)
+		window = mr0_dst[window_index];
 
 	switch(recv_ipc_type) {
 	case IPC_FLAGS_SHORT:
 		if (send_ipc_type == IPC_FLAGS_SHORT)
 			ret = ipc_short_copy(to, from);
-		if (send_ipc_type == IPC_FLAGS_FULL)
+		else
 			ret = ipc_full_copy(to, from);
-		if (send_ipc_type == IPC_FLAGS_EXTENDED)
-			ret = -ENOIPC;
 		break;
 	case IPC_FLAGS_FULL:
-		if (send_ipc_type == IPC_FLAGS_SHORT)
-			ret = ipc_full_copy(to, from);
-		if (send_ipc_type == IPC_FLAGS_FULL)
-			ret = ipc_full_copy(to, from);
-		if (send_ipc_type == IPC_FLAGS_EXTENDED)
-			ret = -ENOIPC;
+		ret = ipc_full_copy(to, from);
 		break;
 	case IPC_FLAGS_EXTENDED:
-		if (send_ipc_type == IPC_FLAGS_EXTENDED)
-			/* We do a short copy as well. */
-			ret = ipc_short_copy(to, from);
+		/* We do a short copy as well. */
+		if ((ret = ipc_short_copy(to, from)) == 0)
 			ret = ipc_extended_copy(to, from);
-		if (send_ipc_type == IPC_FLAGS_SHORT)
-			ret = -ENOIPC;
-		if (send_ipc_type == IPC_FLAGS_FULL)
-			ret = -ENOIPC;
+		break;
+	case IPC_FLAGS_LONG:
+		ret = ipc_long_copy(to, from);
 		break;
 	}
 
+	/* Items go last, so nothing is mapped for a failed message */
+	if (!ret && (tcb_get_ipc_flags(from) & IPC_FLAGS_ITEM_MASK))
+		ret = ipc_map_copy(to, from, window, &received);
+
+	/* Tell the receiver what was mapped into its window, if anything */
+	if (!ret && (tcb_get_ipc_flags(to) & IPC_FLAGS_WINDOW))
+		mr0_dst[window_index] = received;
+
 	/* Save the sender id in case of ANYTHREAD receiver */
-	if (to->expected_sender == L4_ANYTHREAD) {
-       		mr0_dst = KTCB_REF_MR0(to);
+	if (to->expected_sender == L4_ANYTHREAD)
 		mr0_dst[MR_SENDER] = from->tid;
-	}
 
 	return ret;
 }
@@ -208,6 +427,8 @@ int ipc_send(l4id_t recv_tid, unsigned int flags)
 	struct waitqueue_head *wqhs, *wqhr;
 	int ret = 0;
 
+	trace(TRACE_IPC_SEND, recv_tid);
+
 	if (!(receiver = tcb_find_lock(recv_tid)))
 		return -ESRCH;
 
@@ -269,6 +490,8 @@ int ipc_recv(l4id_t senderid, unsigned int flags)
 	struct waitqueue_head *wqhs, *wqhr;
 	int ret = 0;
 
+	trace(TRACE_IPC_RECV, senderid);
+
 	wqhs = &current->wqh_send;
 	wqhr = &current->wqh_recv;
 
@@ -329,6 +552,75 @@ int ipc_recv(l4id_t senderid, unsigned int flags)
 	return ipc_handle_errors();
 }
 
+/*
+ * Notify ipc increments a notify slot in the receiver's utcb and
+ * wakes it up if it waits on the slot. The sender never blocks,
+ * so a notification can be posted whatever the receiver is doing.
+ * The receiver's utcb must be mapped, as it is not paged in on its
+ * behalf.
+ */
+int ipc_notify(l4id_t recv_tid, unsigned int flags)
+{
+	int slot = extended_ipc_msg_index(flags);
+	struct ktcb *receiver;
+	struct utcb *utcb;
+	unsigned long irqsave;
+	int err;
+
+	if (slot >= TASK_NOTIFY_SLOTS)
+		return -EINVAL;
+
+	if (!(receiver = tcb_find_lock(recv_tid)))
+		return -ESRCH;
+
+	if ((err = tcb_check_and_lazy_map_utcb(receiver, 0)) < 0) {
+		spin_unlock(&receiver->thread_lock);
+		return err;
+	}
+
+	utcb = (struct utcb *)receiver->utcb_address;
+
+	/*
+	 * Serialise against other notifiers. The receiver clears
+	 * the slot with a destructive read, so at worst a racing
+	 * clear leaves a spurious count behind, never a lost one.
+	 */
+	spin_lock_irq(&receiver->wqh_notify.slock, &irqsave);
+	if (utcb->notify[slot] != TASK_NOTIFY_MAXVALUE)
+		utcb->notify[slot]++;
+	spin_unlock_irq(&receiver->wqh_notify.slock, irqsave);
+
+	wake_up(&receiver->wqh_notify, WAKEUP_ASYNC);
+
+	spin_unlock(&receiver->thread_lock);
+	return 0;
+}
+
+/*
+ * Waits until the given notify slot of current is non-zero,
+ * and returns the count while clearing the slot.
+ */
+int ipc_notify_wait(unsigned int flags)
+{
+	int slot = extended_ipc_msg_index(flags);
+	struct utcb *utcb = (struct utcb *)current->utcb_address;
+	int ret;
+
+	if (slot >= TASK_NOTIFY_SLOTS)
+		return -EINVAL;
+
+	if ((ret = tcb_check_and_lazy_map_utcb(current, 1)) < 0)
+		return ret;
+
+	WAIT_EVENT(&current->wqh_notify,
+		   utcb->notify[slot] != 0, ret);
+
+	if (ret < 0)
+		return ret;
+
+	return l4_atomic_dest_readb(&utcb->notify[slot]);
+}
+
 /*
  * Both sends and receives mregs in the same call. This is mainly by user
  * tasks for client server communication with system servers.
@@ -364,11 +656,6 @@ int ipc_sendrecv(l4id_t to, l4id_t from, unsigned int flags)
 	return ret;
 }
 
-int ipc_sendrecv_extended(l4id_t to, l4id_t from, unsigned int flags)
-{
-	return -ENOSYS;
-}
-
 /*
  * In extended receive, receive buffers are page faulted before engaging
  * in real ipc.
@@ -422,6 +709,32 @@ int ipc_recv_extended(l4id_t sendertid, unsigned int flags)
 	return 0;
 }
 
+/*
+ * Sends a request in the primary registers and receives the reply
+ * as extended ipc, all in one call. This way the server's reply
+ * finds the client already waiting, rather than blocking until the
+ * client gets round to its receive.
+ */
+int ipc_sendrecv_extended(l4id_t to, l4id_t from, unsigned int flags)
+{
+	int ret;
+
+	if (to != from) {
+		printk("%s: Unsupported ipc operation.\n", __FUNCTION__);
+		return -ENOSYS;
+	}
+
+	/* The request goes out as a short ipc */
+	tcb_set_ipc_flags(current, (flags & ~IPC_FLAGS_TYPE_MASK) |
+			  IPC_FLAGS_SHORT);
+	ret = ipc_send(to, flags);
+	tcb_set_ipc_flags(current, flags);
+	if (ret < 0)
+		return ret;
+
+	return ipc_recv_extended(from, flags);
+}
+
 /*
  * In extended IPC, userspace buffers are copied to process
  * kernel stack before engaging in real calls ipc. If page fault
@@ -474,12 +787,146 @@ int ipc_send_extended(l4id_t recv_tid, unsigned int flags)
 }
 
 
+/*
+ * Long ipc buffers are faulted in by their owner before the
+ * rendezvous, after which it proceeds as an ordinary ipc.
+ */
+int ipc_long_prepare(unsigned int ipc_dir, unsigned int flags)
+{
+	unsigned int *mr0_current = KTCB_REF_MR0(current);
+	int msg_index = extended_ipc_msg_index(flags);
+	unsigned long ipc_address;
+	unsigned int size;
+
+	/* Buffer address and size take two registers */
+	if (msg_index + 1 >= MR_TOTAL)
+		return -EINVAL;
+
+	ipc_address = (unsigned long)mr0_current[msg_index];
+	size = mr0_current[msg_index + 1];
+
+	if (size > IPC_LONG_MAX_SIZE)
+		return -EINVAL;
+
+	return check_access(ipc_address, size,
+			    (ipc_dir & IPC_RECV) ? MAP_USR_RW : MAP_USR_RO,
+			    1);
+}
+
+/* Checks that a flexpage is well formed and in user space */
+static int ipc_fpage_check(unsigned int fpage)
+{
+	unsigned int order = fpage & L4_FPAGE_ORDER_MASK;
+	unsigned long base, end;
+
+	if (order < PAGE_BITS || order > L4_FPAGE_MAX_ORDER)
+		return -EINVAL;
+
+	base = page_align(fpage);
+	end = base + (1UL << order);
+
+	if (end < base || is_kernel_address(base) ||
+	    is_kernel_address(end - 1))
+		return -EINVAL;
+
+	return 0;
+}
+
+/*
+ * Validates the flexpage of a map or grant item, and that of a
+ * receive window in the register after it. A sender's pages are
+ * faulted in here, as the kernel does not page in on behalf of a
+ * task other than current.
+ */
+int ipc_map_prepare(unsigned int ipc_dir, unsigned int flags)
+{
+	unsigned int type = ipc_flags_get_type(flags);
+	int msg_index = extended_ipc_msg_index(flags);
+	unsigned int *mr0_current = KTCB_REF_MR0(current);
+	unsigned int fpage;
+	int err;
+
+	/* Items are carried in primary message registers only */
+	if (type != IPC_FLAGS_SHORT && type != IPC_FLAGS_FULL)
+		return -EINVAL;
+
+	if (flags & IPC_FLAGS_ITEM_MASK) {
+		if (!(ipc_dir & IPC_SEND) || msg_index >= MR_TOTAL)
+			return -EINVAL;
+
+		fpage = mr0_current[msg_index];
+		if ((err = ipc_fpage_check(fpage)) < 0)
+			return err;
+
+		/* Uncached pages are only ever passed on writable */
+		if ((fpage & L4_FPAGE_UNCACHED) &&
+		    (fpage & (L4_FPAGE_WRITE | L4_FPAGE_EXEC)) !=
+		    L4_FPAGE_WRITE)
+			return -EINVAL;
+
+		if ((err = check_access(page_align(fpage),
+					1UL << (fpage & L4_FPAGE_ORDER_MASK),
+					fpage_map_flags(fpage), 1)) < 0)
+			return err;
+	}
+
+	if (flags & IPC_FLAGS_WINDOW) {
+		if (!(ipc_dir & IPC_RECV) || msg_index + 1 >= MR_TOTAL)
+			return -EINVAL;
+
+		if ((err = ipc_fpage_check(mr0_current[msg_index + 1])) < 0)
+			return err;
+	}
+
+	return 0;
+}
+
 static inline int __sys_ipc(l4id_t to, l4id_t from,
 			    unsigned int ipc_dir, unsigned int flags)
 {
 	int ret;
 
-	if (ipc_flags_get_type(flags) == IPC_FLAGS_EXTENDED) {
+	if (ipc_flags_get_type(flags) == IPC_FLAGS_LONG &&
+	    (ret = ipc_long_prepare(ipc_dir, flags)) < 0)
+		return ret;
+
+	if ((flags & (IPC_FLAGS_ITEM_MASK | IPC_FLAGS_WINDOW)) &&
+	    (ret = ipc_map_prepare(ipc_dir, flags)) < 0)
+		return ret;
+
+	if (ipc_flags_get_type(flags) == IPC_FLAGS_NOTIFY) {
+		switch (ipc_dir) {
+		case IPC_SEND:
+			ret = ipc_notify(to, flags);
+			break;
+		case IPC_RECV:
+			ret = ipc_notify_wait(flags);
+			break;
+		case IPC_SENDRECV:
+			if ((ret = ipc_notify(to, flags)) < 0)
+				break;
+			ret = ipc_notify_wait(flags);
+			break;
+		case IPC_INVALID:
+		default:
+			printk("Unsupported ipc operation.\n");
+			ret = -ENOSYS;
+		}
+	} else if (ipc_flags_get_type(flags) == IPC_FLAGS_SIGNAL) {
+		switch (ipc_dir) {
+		case IPC_SEND:
+			ret = ipc_signal(to, flags);
+			break;
+		case IPC_RECV:
+			ret = ipc_signal_wait(flags);
+			break;
+		case IPC_SENDRECV:
+		case IPC_INVALID:
+		default:
+			printk("Unsupported ipc operation.\n");
+			ret = -ENOSYS;
+		}
+	} else if (ipc_flags_get_type(flags) == IPC_FLAGS_EXTENDED) {
 		switch (ipc_dir) {
 		case IPC_SEND:
 			ret = ipc_send_extended(to, flags);
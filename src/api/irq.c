@@ -10,10 +10,30 @@
 #include <l4/generic/capability.h>
 #include <l4/generic/irq.h>
 #include <l4/generic/tcb.h>
+#include <l4/generic/notify.h>
 #include INC_GLUE(message.h)
 #include <l4/lib/wait.h>
 #include INC_SUBARCH(irq.h)
 
+/*
+ * Raises an irq slot of task, waking it up if it waits on the
+ * slot. This is a separate word from the notification bits, so
+ * that signals of peers can neither fake nor eat irqs.
+ */
+static void irq_notify_slot(struct ktcb *task, int slot)
+{
+	unsigned long irqsave;
+	int wake;
+
+	spin_lock_irq(&task->wqh_notify.slock, &irqsave);
+	task->irq_bits |= 1 << slot;
+	wake = task->irq_bits & task->irq_wait_mask;
+	spin_unlock_irq(&task->wqh_notify.slock, irqsave);
+
+	if (wake)
+		wake_up(&task->wqh_notify, WAKEUP_ASYNC);
+}
+
 /*
  * Default function that handles userspace
  * threaded irqs. Increases irq count and wakes
@@ -64,6 +84,9 @@ int irq_thread_notify(struct irq_desc *desc)
 	/* Async wake up any waiter irq threads */
 	wake_up(&desc->wqh_irq, WAKEUP_ASYNC);
 
+	/* Also raise the slot's bit for threads multiplexing on it */
+	irq_notify_slot(desc->task, desc->task_notify_slot);
+
 	BUG_ON(!irqs_enabled());
 	return 0;
 }
@@ -72,10 +95,15 @@ int irq_thread_notify(struct irq_desc *desc)
  * Register the given globally unique irq number with the
  * current thread with given flags
  */
-int irq_control_register(struct ktcb *task, int slot, l4id_t irqnum)
+int irq_control_register(struct ktcb *task, unsigned int flags,
+			 l4id_t irqnum)
 {
+	int slot = flags & IRQ_CONTROL_SLOT_MASK;
 	int err;
 
+	if (slot >= TASK_NOTIFY_SLOTS)
+		return -EINVAL;
+
 	/*
 	 * Check that utcb memory accesses won't fault us.
 	 *
@@ -91,6 +119,9 @@ int irq_control_register(struct ktcb *task, int slot, l4id_t irqnum)
 	if ((err = irq_register(current, slot, irqnum)) < 0)
 		return err;
 
+	if (flags & IRQ_CONTROL_BATCHED)
+		irq_desc_array[irqnum].flags |= IRQ_DESC_BATCHED;
+
 	/* Make thread a real-time task */
 	current->flags |= TASK_REALTIME;
 
@@ -126,6 +157,46 @@ int irq_wait(l4id_t irq_index)
 }
 
 
+/*
+ * Acknowledges all batched lines of current, then waits until
+ * an irq is delivered on any of its registered slots. Returns the
+ * mask of slots that had irqs, whose counts are in the utcb.
+ * This saves a kernel entry per irq for busy devices, as all
+ * irqs that arrive while the thread works are taken in one go.
+ */
+int irq_ack_wait(void)
+{
+	unsigned long irqsave;
+	u32 mask, slots;
+	int ret;
+
+	/* UTCB must be mapped */
+	if ((ret = tcb_check_and_lazy_map_utcb(current, 1)) < 0)
+		return ret;
+
+	if (!(mask = irq_task_slots(current)))
+		return -ENOIRQ;
+
+	irq_ack_lines(current);
+
+	/* Irqs check this under the waitqueue lock */
+	spin_lock_irq(&current->wqh_notify.slock, &irqsave);
+	current->irq_wait_mask = mask;
+	spin_unlock_irq(&current->wqh_notify.slock, irqsave);
+
+	WAIT_EVENT(&current->wqh_notify,
+		   (current->irq_bits & mask) != 0, ret);
+
+	/* Slots are kept if the wait gets interrupted */
+	spin_lock_irq(&current->wqh_notify.slock, &irqsave);
+	current->irq_wait_mask = 0;
+	slots = (ret < 0) ? 0 : current->irq_bits & mask;
+	current->irq_bits &= ~slots;
+	spin_unlock_irq(&current->wqh_notify.slock, irqsave);
+
+	return (ret < 0) ? ret : slots;
+}
+
 /*
  * Register/deregister device irqs. Optional synchronous and
  * asynchronous irq handling.
@@ -142,8 +213,12 @@ int sys_irq_control(unsigned int req, unsigned int flags, l4id_t irqnum)
 	switch (req) {
 	case IRQ_CONTROL_REGISTER:
 		return irq_control_register(task, flags, irqnum);
+	case IRQ_CONTROL_RELEASE:
+		return irq_release(task, irqnum);
 	case IRQ_CONTROL_WAIT:
 		return irq_wait(irqnum);
+	case IRQ_CONTROL_ACK_WAIT:
+		return irq_ack_wait();
 	default:
 		return -EINVAL;
 	}
@@ -6,4 +6,5 @@
 #include INC_API(kip.h)
 
 SECTION(".data.kip") ALIGN(SZ_4K) struct kip kip;
+SECTION(".data.kip") ALIGN(SZ_4K) struct time_page time_page;
 
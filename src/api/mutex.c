@@ -9,6 +9,7 @@
 #include <l4/generic/scheduler.h>
 #include <l4/generic/container.h>
 #include <l4/generic/tcb.h>
+#include <l4/generic/trace.h>
 #include <l4/api/kip.h>
 #include <l4/api/errno.h>
 #include <l4/api/mutex.h>
@@ -156,6 +157,7 @@ int mutex_control_lock(struct mutex_queue_head *mqhead,
 		       unsigned long mutex_address)
 {
 	struct mutex_queue *mutex_queue;
+	int ret;
 
 	mutex_queue_head_lock(mqhead);
 
@@ -199,8 +201,14 @@ int mutex_control_lock(struct mutex_queue_head *mqhead,
 	/* Release lock */
 	mutex_queue_head_unlock(mqhead);
 
+	trace(TRACE_MUTEX_WAIT, mutex_address);
+
 	/* Initiate prepared wait */
-	return wait_on_prepared_wait();
+	ret = wait_on_prepared_wait();
+
+	trace(TRACE_MUTEX_WOKEN, mutex_address);
+
+	return ret;
 }
 
 int mutex_control_unlock(struct mutex_queue_head *mqhead,
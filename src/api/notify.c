@@ -0,0 +1,220 @@
+/*
+ * Asynchronous notification bits
+ *
+ * Every thread has a word of notification bits that authorised
+ * threads and irqs raise without blocking. A thread waits for any
+ * of a set of bits at once, so that a single server thread can
+ * multiplex irqs, timer expiries and peer events.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4/generic/notify.h>
+#include <l4/generic/tcb.h>
+#include <l4/generic/time.h>
+#include <l4/api/ipc.h>
+#include <l4/api/errno.h>
+#include <l4/lib/wait.h>
+#include INC_API(syscall.h)
+#include INC_GLUE(message.h)
+#include INC_GLUE(ipc.h)
+
+/*
+ * Raises bits in task, waking it up if it waits on any of them.
+ * This may be called from irq context.
+ */
+void notify_signal(struct ktcb *task, u32 bits)
+{
+	unsigned long irqsave;
+	int wake;
+
+	spin_lock_irq(&task->wqh_notify.slock, &irqsave);
+	task->notify_bits |= bits;
+	wake = task->notify_bits & task->notify_wait_mask;
+	spin_unlock_irq(&task->wqh_notify.slock, irqsave);
+
+	if (wake)
+		wake_up(&task->wqh_notify, WAKEUP_ASYNC);
+}
+
+/* Raises the bits in the message register given by flags */
+int ipc_signal(l4id_t to, unsigned int flags)
+{
+	int msg_index = extended_ipc_msg_index(flags);
+	struct ktcb *receiver;
+	u32 bits;
+
+	if (msg_index >= MR_TOTAL)
+		return -EINVAL;
+
+	bits = KTCB_REF_MR0(current)[msg_index];
+
+	if (!(receiver = tcb_find_lock(to)))
+		return -ESRCH;
+
+	notify_signal(receiver, bits);
+
+	spin_unlock(&receiver->thread_lock);
+	return 0;
+}
+
+/*
+ * Timed waits. A thread waiting with a timeout is kept on a list in
+ * expiry order, which the timer cpu runs on each tick and on idle
+ * exit. The earliest expiry also bounds how long a tickless idle
+ * cpu may sleep, so a timed wait never needs a polling thread.
+ */
+static DECLARE_SPINLOCK(notify_timer_lock);
+static LINK_DECLARE(notify_timer_list);
+
+/* Expiries are in wrapping jiffies, compare them by distance */
+#define time_before(a, b)	((int)((a) - (b)) < 0)
+
+static void notify_timer_arm(struct ktcb *task, u32 ticks)
+{
+	unsigned long irqsave;
+	struct ktcb *t;
+
+	spin_lock_irq(&notify_timer_lock, &irqsave);
+	task->notify_timer_expiry = jiffies + ticks;
+
+	list_foreach_struct(t, &notify_timer_list, notify_timer)
+		if (time_before(task->notify_timer_expiry,
+				t->notify_timer_expiry))
+			break;
+
+	/* In front of the first later one, or at the end */
+	list_insert_tail(&task->notify_timer, &t->notify_timer);
+	spin_unlock_irq(&notify_timer_lock, irqsave);
+}
+
+void notify_timer_cancel(struct ktcb *task)
+{
+	unsigned long irqsave;
+
+	spin_lock_irq(&notify_timer_lock, &irqsave);
+	list_remove_init(&task->notify_timer);
+	spin_unlock_irq(&notify_timer_lock, irqsave);
+}
+
+/* Wakes up the waiters whose timeouts have expired */
+void notify_timer_run(void)
+{
+	struct ktcb *task, *n;
+	unsigned long irqsave, flags;
+
+	spin_lock_irq(&notify_timer_lock, &irqsave);
+	list_foreach_removable_struct(task, n, &notify_timer_list,
+				      notify_timer) {
+		if (time_before(jiffies, task->notify_timer_expiry))
+			break;
+
+		list_remove_init(&task->notify_timer);
+
+		spin_lock_irq(&task->wqh_notify.slock, &flags);
+		task->notify_timed_out = 1;
+		spin_unlock_irq(&task->wqh_notify.slock, flags);
+
+		wake_up(&task->wqh_notify, WAKEUP_ASYNC);
+	}
+	spin_unlock_irq(&notify_timer_lock, irqsave);
+}
+
+/* Ticks until the earliest timeout, or 0 if there is none */
+u32 notify_timer_next(void)
+{
+	unsigned long irqsave;
+	struct ktcb *task;
+	u32 ticks = 0;
+
+	spin_lock_irq(&notify_timer_lock, &irqsave);
+	if (!list_empty(&notify_timer_list)) {
+		task = link_to_struct(notify_timer_list.next,
+				      struct ktcb, notify_timer);
+		ticks = time_before(jiffies, task->notify_timer_expiry) ?
+			task->notify_timer_expiry - jiffies : 1;
+	}
+	spin_unlock_irq(&notify_timer_lock, irqsave);
+
+	return ticks;
+}
+
+/*
+ * Waits for any of the bits in mask, and returns the pending
+ * ones in *bits, clearing them. Bits are kept if the wait gets
+ * interrupted. With non-zero ticks, the wait gives up with
+ * -ETIMEDOUT once that many ticks pass without a bit.
+ */
+int notify_wait_timeout(u32 mask, u32 *bits, u32 ticks)
+{
+	unsigned long irqsave;
+	int ret;
+
+	/* Signallers check this under the waitqueue lock */
+	spin_lock_irq(&current->wqh_notify.slock, &irqsave);
+	current->notify_wait_mask = mask;
+	current->notify_timed_out = 0;
+	spin_unlock_irq(&current->wqh_notify.slock, irqsave);
+
+	if (ticks)
+		notify_timer_arm(current, ticks);
+
+	WAIT_EVENT(&current->wqh_notify,
+		   (current->notify_bits & mask) != 0 ||
+		   current->notify_timed_out, ret);
+
+	if (ticks)
+		notify_timer_cancel(current);
+
+	spin_lock_irq(&current->wqh_notify.slock, &irqsave);
+	current->notify_wait_mask = 0;
+	*bits = (ret < 0) ? 0 : current->notify_bits & mask;
+	current->notify_bits &= ~*bits;
+	if (!ret && !*bits)
+		ret = -ETIMEDOUT;
+	spin_unlock_irq(&current->wqh_notify.slock, irqsave);
+
+	return ret;
+}
+
+int notify_wait(u32 mask, u32 *bits)
+{
+	return notify_wait_timeout(mask, bits, 0);
+}
+
+/* Scheduler ticks for a timeout in ms, rounded up */
+static inline u32 notify_ms_to_ticks(u32 ms)
+{
+	return ms / 1000 * CONFIG_SCHED_TICKS +
+	       ((ms % 1000) * CONFIG_SCHED_TICKS + 999) / 1000;
+}
+
+/*
+ * Waits for any of the bits in the message register given by
+ * flags, and hands back the pending ones in the same register.
+ * With IPC_FLAGS_TIMEOUT, the next register has a timeout in ms.
+ */
+int ipc_signal_wait(unsigned int flags)
+{
+	int msg_index = extended_ipc_msg_index(flags);
+	unsigned int *mr0_current = KTCB_REF_MR0(current);
+	u32 mask, bits, ticks = 0;
+	int ret;
+
+	if (msg_index >= MR_TOTAL)
+		return -EINVAL;
+
+	if (!(mask = mr0_current[msg_index]))
+		return -EINVAL;
+
+	if (flags & IPC_FLAGS_TIMEOUT) {
+		if (msg_index + 1 >= MR_TOTAL)
+			return -EINVAL;
+		ticks = notify_ms_to_ticks(mr0_current[msg_index + 1]);
+	}
+
+	if ((ret = notify_wait_timeout(mask, &bits, ticks)) < 0)
+		return ret;
+
+	mr0_current[msg_index] = bits;
+	return 0;
+}
@@ -12,11 +12,15 @@
 #include <l4/generic/space.h>
 #include <l4/generic/capability.h>
 #include <l4/generic/container.h>
+#include <l4/generic/irq.h>
+#include <l4/generic/trace.h>
+#include <l4/generic/debug.h>
 #include <l4/api/space.h>
 #include <l4/api/ipc.h>
 #include <l4/api/kip.h>
 #include <l4/api/errno.h>
 #include <l4/api/exregs.h>
+#include <l4/api/container.h>
 #include INC_API(syscall.h)
 #include INC_ARCH(exception.h)
 
@@ -53,9 +57,37 @@ int sys_getid(struct task_ids *ids)
 	return 0;
 }
 
+/*
+ * Kernel statistics and traces are visible to the whole
+ * system, so only pagers may read them.
+ */
 int sys_container_control(unsigned int req, unsigned int flags, void *userbuf)
 {
-	return 0;
+	if (!thread_is_pager(current))
+		return -EPERM;
+
+	switch (req) {
+#if defined(CONFIG_DEBUG_IRQ_LATENCY)
+	case CONTAINER_CONTROL_IRQ_LATENCY:
+		return irq_latency_read(flags, userbuf);
+#endif
+#if defined(CONFIG_DEBUG_ACCOUNTING)
+	case CONTAINER_CONTROL_ACCOUNTING:
+		return system_accounting_read(flags, userbuf);
+#endif
+#if defined(CONFIG_DEBUG_TRACE)
+	case CONTAINER_CONTROL_TRACE_MAP:
+		return trace_map(flags, (unsigned long)userbuf);
+	case CONTAINER_CONTROL_TRACE_MASK:
+		return trace_set_mask(flags);
+#endif
+#if defined(CONFIG_PRINTK_ASYNC)
+	case CONTAINER_CONTROL_LOG:
+		return printk_log_read(flags, userbuf);
+#endif
+	default:
+		return -EINVAL;
+	}
 }
 
 
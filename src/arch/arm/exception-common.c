@@ -11,6 +11,8 @@
 #include <l4/generic/tcb.h>
 #include <l4/generic/platform.h>
 #include <l4/generic/debug.h>
+#include <l4/generic/time.h>
+#include <l4/generic/trace.h>
 #include <l4/lib/printk.h>
 #include <l4/api/ipc.h>
 #include <l4/api/kip.h>
@@ -24,6 +26,15 @@
 #include INC_SUBARCH(mm.h)
 
 
+/* Charge the aborted context up to here */
+static inline void abort_account_entry(u32 spsr)
+{
+	if (is_user_mode(spsr))
+		account_user_time();
+	else
+		account_kernel_time();
+}
+
 void abort_die(void)
 {
 	disable_irqs();
@@ -125,6 +136,8 @@ fault_ipc_to_pager(u32 faulty_pc, u32 fsr, u32 far, u32 ipc_tag)
 		thread_destroy(current);
 	}
 
+	trace(TRACE_PFAULT_IPC, is_prefetch_abort(fsr) ? faulty_pc : far);
+
 	/* Send ipc to the task's pager */
 	if ((err = ipc_sendrecv(tcb_pagerid(current),
 				tcb_pagerid(current), 0)) < 0) {
@@ -194,6 +207,7 @@ void data_abort_handler(u32 faulted_pc, u32 dfsr, u32 dfar, u32 spsr)
 	int ret;
 
 	system_account_dabort();
+	abort_account_entry(spsr);
 
 	/* Indicate abort type on dfsr */
 	set_abort_type(dfsr, ABORT_TYPE_DATA);
@@ -208,7 +222,7 @@ void data_abort_handler(u32 faulted_pc, u32 dfsr, u32 dfar, u32 spsr)
 	if ((ret = check_abort_type(faulted_pc, dfsr, dfar, spsr)) < 0)
 		goto die; /* Die if irrecoverable */
 	else if (ret == ABORT_HANDLED)
-		return;
+		goto out;
 
 	/* Notify the pager */
 	fault_ipc_to_pager(faulted_pc, dfsr, dfar, L4_IPC_TAG_PFAULT);
@@ -227,6 +241,8 @@ void data_abort_handler(u32 faulted_pc, u32 dfsr, u32 dfar, u32 spsr)
 		sched_suspend_sync();
 	}
 
+out:
+	account_kernel_time();
 	return;
 die:
 	dprintk("FAR:", dfar);
@@ -239,6 +255,7 @@ void prefetch_abort_handler(u32 faulted_pc, u32 ifsr, u32 ifar, u32 spsr)
 	int ret;
 
 	system_account_pabort();
+	abort_account_entry(spsr);
 
 	/* Indicate abort type on dfsr */
 	set_abort_type(ifsr, ABORT_TYPE_PREFETCH);
@@ -254,7 +271,7 @@ void prefetch_abort_handler(u32 faulted_pc, u32 ifsr, u32 ifar, u32 spsr)
 	if ((ret = check_abort_type(0, ifsr, ifar, spsr)) < 0)
 		goto die; /* Die if irrecoverable */
 	else if (ret == ABORT_HANDLED)
-		return; /* Return if handled internally */
+		goto out; /* Return if handled internally */
 
 	/* Notify the pager */
 	fault_ipc_to_pager(faulted_pc, ifsr, ifar, L4_IPC_TAG_PFAULT);
@@ -273,6 +290,8 @@ void prefetch_abort_handler(u32 faulted_pc, u32 ifsr, u32 ifar, u32 spsr)
 		sched_suspend_sync();
 	}
 
+out:
+	account_kernel_time();
 	return;
 die:
 	dprintk("FAR:", ifar);
@@ -285,6 +304,7 @@ void undefined_instr_handler(u32 undefined_address, u32 spsr, u32 lr)
 	dbg_abort("Undefined instruction. PC:0x%x", undefined_address);
 
 	system_account_undef_abort();
+	abort_account_entry(spsr);
 
 	fault_ipc_to_pager(undefined_address, 0, undefined_address,
 			   L4_IPC_TAG_UNDEF_FAULT);
@@ -301,6 +321,7 @@ void undefined_instr_handler(u32 undefined_address, u32 spsr, u32 lr)
 		sched_suspend_sync();
 	}
 
+	account_kernel_time();
 	return;
 
 die:
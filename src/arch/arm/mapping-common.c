@@ -18,6 +18,10 @@
 #include <l4/generic/tcb.h>
 #include <l4/generic/bootmem.h>
 #include <l4/generic/space.h>
+#include <l4/generic/smp.h>
+#include <l4/generic/scheduler.h>
+#include <l4/generic/time.h>
+#include INC_ARCH(irq.h)
 
 /* Find out whether a pmd exists or not and return it */
 pmd_table_t *pmd_exists(pgd_table_t *task_pgd, unsigned long vaddr)
@@ -306,6 +310,31 @@ int check_mapping(unsigned long vaddr, unsigned long size,
 				 TASK_PGD(current));
 }
 
+/*
+ * Checks that pages are mapped with the cache attributes of the
+ * given flags, so that a page passed on to another space is not
+ * aliased there as a different memory type.
+ */
+int check_mapping_cache_pgd(unsigned long vaddr, unsigned long size,
+			    unsigned int flags, pgd_table_t *pgd)
+{
+	unsigned int npages = __pfn(align_up(size, PAGE_SIZE));
+	unsigned int cache_mask = cacheable | bufferable;
+	pte_t pte;
+
+	/* Convert generic map flags to pagetable-specific */
+	BUG_ON(!(flags = space_flags_to_ptflags(flags)));
+
+	for (int i = 0; i < npages; i++) {
+		pte = virt_to_pte_from_pgd(pgd, vaddr + i * PAGE_SIZE);
+
+		if ((pte & cache_mask) != (flags & cache_mask))
+			return 0;
+	}
+
+	return 1;
+}
+
 /*
  * This can be made common for v5/v7, keeping split/page table
  * and cache flush parts in arch-specific files.
@@ -396,7 +425,7 @@ int copy_user_tables(struct address_space *new,
 				PMD_ALIGN_MASK));
 
 			/* Copy original to new */
-			memcpy(pmd, orig, sizeof(pmd_table_t));
+			copy_blocks(pmd, orig, sizeof(pmd_table_t));
 
 			/* Replace original pmd entry in pgd with new */
 			to->entry[i] = (pmd_t)(virt_to_phys(pmd)
@@ -477,3 +506,106 @@ void remap_as_pages(void *vstart, void *vend)
 	       npages);
 }
 
+/*
+ * Sets up the per-cpu copy windows. A boot mapping is made
+ * only to get the window pmd allocated in the global pgd, so
+ * that all tasks share it. The pte is cleared right away.
+ */
+void copy_window_init(void)
+{
+	for (int cpu = 0; cpu < CONFIG_NCPU; cpu++) {
+		add_boot_mapping(virt_to_phys(page_align(_start_kernel)),
+				 COPY_WINDOW_VADDR(cpu), PAGE_SIZE,
+				 MAP_KERN_RW);
+		remove_mapping(COPY_WINDOW_VADDR(cpu));
+	}
+}
+
+/*
+ * Maps the page of a task that contains vaddr into the copy
+ * window of this cpu, and returns the kernel address that
+ * corresponds to vaddr. Returns 0 if the page is not mapped
+ * in the task with the given access flags.
+ *
+ * The pte is written directly rather than with the whole cache
+ * and tlb flush of arch_write_pte(). Only the window's own tlb
+ * entry and cache lines can be stale, and those are dealt with
+ * by MVA here and in copy_window_unmap().
+ *
+ * NOTE: Preemption must be disabled while the window is used.
+ */
+unsigned long copy_window_map(struct ktcb *task, unsigned long vaddr,
+			      unsigned int flags)
+{
+	unsigned long window = COPY_WINDOW_VADDR(smp_get_cpuid());
+	unsigned long page = page_align(vaddr);
+	pte_t *ptep = virt_to_ptep_from_pgd(&init_pgd, window);
+
+	if (!check_mapping_pgd(page, PAGE_SIZE, flags, TASK_PGD(task)))
+		return 0;
+
+	arch_prepare_pte(virt_to_phys_by_pgd(TASK_PGD(task), page),
+			 window, space_flags_to_ptflags(MAP_KERN_RW), ptep);
+
+	/* Table walks do not look in the dcache */
+	arm_clean_dcache_line((unsigned long)ptep);
+	arm_invalidate_tlb_page(window);
+
+	return window | (vaddr & PAGE_MASK);
+}
+
+/*
+ * The window's lines are written back and dropped before the
+ * pte goes, as the cache is virtual on v5 and the next page seen
+ * through the window is another one.
+ */
+void copy_window_unmap(void)
+{
+	unsigned long window = COPY_WINDOW_VADDR(smp_get_cpuid());
+	pte_t *ptep = virt_to_ptep_from_pgd(&init_pgd, window);
+
+	arm_clean_invalidate_dcache_page(window);
+
+	arch_prepare_pte(0, window, space_flags_to_ptflags(MAP_FAULT), ptep);
+	arm_clean_dcache_line((unsigned long)ptep);
+	arm_invalidate_tlb_page(window);
+}
+
+/*
+ * Asks busier cpus for work, and halts the cpu until there is
+ * something to run. Irqs are disabled so that a wakeup can't
+ * slip in between the check and the wait. A pending irq still
+ * wakes the core, and it is taken as soon as irqs are enabled.
+ * Ticks are only stopped when the cpu really goes to sleep.
+ */
+static inline void idle_wait(void)
+{
+	disable_irqs();
+	sched_balance_idle();
+	if (!sched_has_runnable()) {
+		tick_nohz_idle_enter();
+		arm_wait_for_interrupt();
+		tick_nohz_idle_exit();
+	}
+	enable_irqs();
+}
+
+void idle_task(void)
+{
+	while(1) {
+		/* Do maintenance */
+		tcb_delete_zombies();
+
+		/* Clear idle runnable flag */
+		per_cpu(scheduler).flags &= ~SCHED_RUN_IDLE;
+
+		/* Idle time goes to buffered console output first */
+		while (!sched_has_runnable() && printk_drain())
+			;
+
+		/* Sleep until there is work */
+		idle_wait();
+
+		schedule();
+	}
+}
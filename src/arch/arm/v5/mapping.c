@@ -197,8 +197,11 @@ int is_global_pgdi(int i)
 	     i < PGD_INDEX(IO_AREA_END)) ||
 	    (i == PGD_INDEX(USER_KIP_PAGE)) ||
 	    (i == PGD_INDEX(ARM_HIGH_VECTOR)) ||
-	    (i == PGD_INDEX(ARM_SYSCALL_VECTOR)) ||
-	    (i == PGD_INDEX(USERSPACE_CONSOLE_VBASE)))
+	    (i == PGD_INDEX(ARM_SYSCALL_VECTOR))
+#if defined(CONFIG_USERSPACE_CONSOLE)
+	    || (i == PGD_INDEX(USERSPACE_CONSOLE_VBASE))
+#endif
+	    )
 		return 1;
 	else
 		return 0;
@@ -330,15 +333,20 @@ void arch_copy_pgd_kernel_entries(pgd_table_t *to)
 				  KERNEL_AREA_END);
 	copy_pgd_global_by_vrange(to, from, IO_AREA_START, IO_AREA_END);
 	copy_pgd_global_by_vrange(to, from, USER_KIP_PAGE,
-				  USER_KIP_PAGE + PAGE_SIZE);
+				  USER_TIME_PAGE + PAGE_SIZE);
 	copy_pgd_global_by_vrange(to, from, ARM_HIGH_VECTOR,
 				  ARM_HIGH_VECTOR + PAGE_SIZE);
 	copy_pgd_global_by_vrange(to, from, ARM_SYSCALL_VECTOR,
 				  ARM_SYSCALL_VECTOR + PAGE_SIZE);
 
-	/* We temporarily map uart registers to every process */
+#if defined(CONFIG_USERSPACE_CONSOLE)
+	/*
+	 * We temporarily map uart registers to every process.
+	 * Without them tasks log via the uart service console.
+	 */
 	copy_pgd_global_by_vrange(to, from, USERSPACE_CONSOLE_VBASE,
 				  USERSPACE_CONSOLE_VBASE + PAGE_SIZE);
+#endif
 }
 
 void arch_update_utcb(unsigned long utcb_address)
@@ -359,17 +367,3 @@ void arch_space_switch(struct ktcb *to)
 	arm_set_ttb(virt_to_phys(pgd));
 	arm_invalidate_tlb();
 }
-
-void idle_task(void)
-{
-	while(1) {
-		/* Do maintenance */
-		tcb_delete_zombies();
-
-		/* Clear idle runnable flag */
-		per_cpu(scheduler).flags &= ~SCHED_RUN_IDLE;
-
-		schedule();
-	}
-}
-
@@ -19,6 +19,12 @@ void timer_irq_clear(unsigned long timer_base)
 	write(1, timer_base + SP804_INTCLR);
 }
 
+/* Whether the timer has expired since its irq was last cleared */
+int timer_irq_raw(unsigned long timer_base)
+{
+	return read(timer_base + SP804_RIS) & 1;
+}
+
 /* Enable timer with its current configuration */
 void timer_start(unsigned long timer_base)
 {
@@ -62,6 +68,18 @@ void timer_init_periodic(unsigned long timer_base, unsigned int load_value)
 		timer_load(1000, timer_base);
 }
 
+/*
+ * Periodic as above, except that the first period is first_value
+ * long. Later ones reload from the background load register.
+ */
+void timer_init_periodic_phase(unsigned long timer_base,
+			       unsigned int load_value,
+			       unsigned int first_value)
+{
+	timer_init_periodic(timer_base, first_value);
+	write(load_value, timer_base + SP804_BGLOAD);
+}
+
 void timer_init_oneshot(unsigned long timer_base)
 {
 	volatile u32 reg = read(timer_base + SP804_CTRL);
@@ -72,6 +90,31 @@ void timer_init_oneshot(unsigned long timer_base)
 	write(reg, timer_base + SP804_CTRL);
 }
 
+/*
+ * Free running, 32 bits, no irqs. Counts down from
+ * 0xFFFFFFFF and wraps around, e.g. for a clock source.
+ */
+void timer_init_freerunning(unsigned long timer_base)
+{
+	write(SP804_32BIT, timer_base + SP804_CTRL);
+	timer_load(0xFFFFFFFF, timer_base);
+}
+
+/*
+ * One shot, 32 bits, irq on expiry. Starts counting down
+ * from load_value right away and halts once it hits zero.
+ * A pending expiry of the previous mode is cleared, callers
+ * that count expiries read it first with timer_irq_raw().
+ */
+void timer_start_oneshot(unsigned long timer_base, unsigned int load_value)
+{
+	write(0, timer_base + SP804_CTRL);
+	timer_irq_clear(timer_base);
+	timer_load(load_value, timer_base);
+	write(SP804_ONESHOT | SP804_32BIT | SP804_IRQEN | SP804_ENABLE,
+	      timer_base + SP804_CTRL);
+}
+
 void timer_init(unsigned long timer_base, unsigned int load_value)
 {
 	timer_init_periodic(timer_base, load_value);
@@ -139,6 +139,12 @@ void uart_tx_char(unsigned long uart_base, char c)
 	write(c, uart_base + OMAP_UART_THR);
 }
 
+/* Tells if uart_tx_char() would have to wait */
+int uart_tx_full(unsigned long uart_base)
+{
+	return !(read(uart_base + OMAP_UART_LSR) & OMAP_UART_TXFE);
+}
+
 #define OMAP_UART_RXFNE			0x1
 #define OMAP_UART_RX_FIFO_STATUS	0x8
 char uart_rx_char(unsigned long uart_base)
@@ -226,6 +226,12 @@ void uart_tx_char(unsigned long base, char c)
 	write(c, (base + PL011_UARTDR));
 }
 
+/* Tells if uart_tx_char() would have to wait */
+int uart_tx_full(unsigned long base)
+{
+	return read(base + PL011_UARTFR) & PL011_TXFF;
+}
+
 char uart_rx_char(unsigned long base)
 {
 	unsigned int val = 0;
@@ -21,6 +21,8 @@
 #include INC_GLUE(ipc.h)
 #include INC_PLAT(irq.h)
 
+unsigned int cap_generation;
+
 void capability_init(struct capability *cap)
 {
 	cap->capid = id_new(&kernel_resources.capability_ids);
@@ -116,6 +118,132 @@ int cap_count(struct ktcb *task)
 typedef struct capability *(*cap_match_func_t) \
 	(struct capability *cap, void *match_args);
 
+#define cap_list_next(cap)	\
+	link_to_struct((cap)->list.next, struct capability, list)
+#define cap_list_prev(cap)	\
+	link_to_struct((cap)->list.prev, struct capability, list)
+
+/*
+ * Inserts cap at the end of caps of its type that start
+ * no later than it does, keeping the list grouped.
+ */
+void cap_list_insert(struct capability *cap, struct cap_list *clist)
+{
+	int index = cap_type_index(cap_type(cap));
+	struct capability *pos;
+	struct link *before = &clist->caps;
+
+	list_foreach_struct(pos, &clist->caps, list) {
+		int pos_index = cap_type_index(cap_type(pos));
+
+		if (pos_index > index ||
+		    (pos_index == index && pos->start > cap->start)) {
+			before = &pos->list;
+			break;
+		}
+	}
+
+	/* Goes right in front of the first cap that sorts after it */
+	list_insert_tail(&cap->list, before);
+	clist->ncaps++;
+
+	/* Starts its group if nothing of its type precedes it */
+	if (cap->list.prev == &clist->caps ||
+	    cap_type_index(cap_type(cap_list_prev(cap))) != index)
+		clist->type_first[index] = cap;
+
+	cap_generation_bump();
+}
+
+void cap_list_remove(struct capability *cap, struct cap_list *clist)
+{
+	int index = cap_type_index(cap_type(cap));
+	struct capability *next = cap_list_next(cap);
+
+	/* Pass the start of the group on to the next, if any */
+	if (clist->type_first[index] == cap) {
+		if (&next->list != &clist->caps &&
+		    cap_type_index(cap_type(next)) == index)
+			clist->type_first[index] = next;
+		else
+			clist->type_first[index] = 0;
+	}
+
+	list_remove(&cap->list);
+	clist->ncaps--;
+
+	cap_generation_bump();
+}
+
+/* Moves all caps over, each to its place in the new list */
+void cap_list_move(struct cap_list *to, struct cap_list *from)
+{
+	struct capability *cap, *n;
+
+	list_foreach_removable_struct(cap, n, &from->caps, list) {
+		cap_list_remove(cap, from);
+		cap_list_insert(cap, to);
+	}
+}
+
+/*
+ * Tries match on caps of one type in a list, stopping
+ * at caps that start beyond limit.
+ */
+static inline struct capability *
+cap_list_find(struct cap_list *clist, cap_match_func_t cap_match_func,
+	      void *match_args, unsigned int cap_type,
+	      unsigned long limit)
+{
+	struct capability *cap, *found;
+
+	for (cap = clist->type_first[cap_type_index(cap_type)];
+	     cap && &cap->list != &clist->caps &&
+	     cap_type(cap) == cap_type && cap->start <= limit;
+	     cap = cap_list_next(cap))
+		if ((found = cap_match_func(cap, match_args)))
+			return found;
+
+	return 0;
+}
+
+/*
+ * Tries match on caps that last matched for task. They are
+ * still on its lists if no list changed since, so a match
+ * gives the same result as a full search would.
+ */
+static inline struct capability *
+cap_cache_find(struct ktcb *task, cap_match_func_t cap_match_func,
+	       void *match_args, unsigned int cap_type)
+{
+	struct cap_cache *cache = &task->cap_cache;
+	struct capability *cap, *found;
+
+	if (cache->generation != cap_generation) {
+		cap_cache_flush(cache);
+		return 0;
+	}
+
+	for (int i = 0; i < CAP_CACHE_SIZE; i++)
+		if ((cap = cache->cap[i]) && cap_type(cap) == cap_type &&
+		    (found = cap_match_func(cap, match_args)))
+			return found;
+
+	return 0;
+}
+
+static inline struct capability *
+cap_cache_add(struct ktcb *task, struct capability *cap)
+{
+	struct cap_cache *cache = &task->cap_cache;
+
+	if (cap) {
+		cache->cap[cache->next] = cap;
+		cache->next = (cache->next + 1) % CAP_CACHE_SIZE;
+	}
+	return cap;
+}
+
 /*
  * This is used by every system call to match each
  * operation with a capability in a syscall-specific way.
@@ -123,21 +251,47 @@ typedef struct capability *(*cap_match_func_t) \
 struct capability *cap_find(struct ktcb *task, cap_match_func_t cap_match_func,
 			    void *match_args, unsigned int cap_type)
 {
-	struct capability *cap, *found;
+	struct capability *found;
+
+	if ((found = cap_cache_find(task, cap_match_func,
+				    match_args, cap_type)))
+		return found;
 
 	/* Search space list */
-	list_foreach_struct(cap, &task->space->cap_list.caps, list)
-		if (cap_type(cap) == cap_type &&
-		    ((found = cap_match_func(cap, match_args))))
-			return found;
+	if ((found = cap_list_find(&task->space->cap_list, cap_match_func,
+				   match_args, cap_type, ~0UL)))
+		return cap_cache_add(task, found);
 
 	/* Search container list */
-	list_foreach_struct(cap, &task->container->cap_list.caps, list)
-		if (cap_type(cap) == cap_type &&
-		    ((found = cap_match_func(cap, match_args))))
-			return found;
+	return cap_cache_add(task,
+			     cap_list_find(&task->container->cap_list,
+					   cap_match_func, match_args,
+					   cap_type, ~0UL));
+}
 
-	return 0;
+/*
+ * Same as cap_find() for memory caps, which can't
+ * contain pfn if they start after it.
+ */
+struct capability *cap_find_mem(struct ktcb *task,
+				cap_match_func_t cap_match_func,
+				void *match_args, unsigned int cap_type,
+				unsigned long pfn)
+{
+	struct capability *found;
+
+	if ((found = cap_cache_find(task, cap_match_func,
+				    match_args, cap_type)))
+		return found;
+
+	if ((found = cap_list_find(&task->space->cap_list, cap_match_func,
+				   match_args, cap_type, pfn)))
+		return cap_cache_add(task, found);
+
+	return cap_cache_add(task,
+			     cap_list_find(&task->container->cap_list,
+					   cap_match_func, match_args,
+					   cap_type, pfn));
 }
 
 struct sys_ipc_args {
@@ -173,6 +327,15 @@ cap_match_ipc(struct capability *cap, void *args_ptr)
 		if (!(cap->access & CAP_IPC_EXTENDED))
 			return 0;
 		break;
+	case IPC_FLAGS_LONG:
+		if (!(cap->access & CAP_IPC_LONG))
+			return 0;
+		break;
+	case IPC_FLAGS_NOTIFY:
+	case IPC_FLAGS_SIGNAL:
+		if (!(cap->access & CAP_IPC_ASYNC))
+			return 0;
+		break;
 	default:
 		return 0;
 	}
@@ -499,10 +662,12 @@ struct capability *cap_match_irqctrl(struct capability *cap,
 	/* Check operation privileges */
 	switch (args->req) {
 	case IRQ_CONTROL_REGISTER:
+	case IRQ_CONTROL_RELEASE:
 		if (!(cap->access & CAP_IRQCTRL_REGISTER))
 			return 0;
 		break;
 	case IRQ_CONTROL_WAIT:
+	case IRQ_CONTROL_ACK_WAIT:
 		if (!(cap->access & CAP_IRQCTRL_WAIT))
 			return 0;
 		break;
@@ -601,12 +766,41 @@ int cap_map_check(struct ktcb *target, unsigned long phys, unsigned long virt,
 		.flags = flags,
 	};
 
-	if (!(physmem =	cap_find(current, cap_match_mem,
-				 &args, CAP_TYPE_MAP_PHYSMEM)))
+	if (!(physmem =	cap_find_mem(current, cap_match_mem, &args,
+				     CAP_TYPE_MAP_PHYSMEM, __pfn(phys))))
+		return -ENOCAP;
+
+	if (!(virtmem = cap_find_mem(current, cap_match_mem, &args,
+				     CAP_TYPE_MAP_VIRTMEM, __pfn(virt))))
+		return -ENOCAP;
+
+	return 0;
+}
+
+/*
+ * Checks a map item passed in ipc. The sender must own the
+ * physical pages it passes on, and the receiver the virtual
+ * range of its window that they are mapped to.
+ */
+int cap_map_item_check(struct ktcb *from, struct ktcb *to,
+		       unsigned long phys, unsigned long virt,
+		       unsigned long npages, unsigned int flags)
+{
+	struct sys_map_args args = {
+		.task = from,
+		.phys = phys,
+		.virt = virt,
+		.npages = npages,
+		.flags = flags,
+	};
+
+	if (!cap_find_mem(from, cap_match_mem, &args,
+			  CAP_TYPE_MAP_PHYSMEM, __pfn(phys)))
 		return -ENOCAP;
 
-	if (!(virtmem = cap_find(current, cap_match_mem,
-				 &args, CAP_TYPE_MAP_VIRTMEM)))
+	args.task = to;
+	if (!cap_find_mem(to, cap_match_mem, &args,
+			  CAP_TYPE_MAP_VIRTMEM, __pfn(virt)))
 		return -ENOCAP;
 
 	return 0;
@@ -625,8 +819,8 @@ int cap_unmap_check(struct ktcb *target, unsigned long virt,
 		.flags = MAP_UNMAP,
 	};
 
-	if (!(virtmem = cap_find(current, cap_match_mem,
-				 &args, CAP_TYPE_MAP_VIRTMEM)))
+	if (!(virtmem = cap_find_mem(current, cap_match_mem, &args,
+				     CAP_TYPE_MAP_VIRTMEM, __pfn(virt))))
 		return -ENOCAP;
 
 	return 0;
@@ -734,8 +928,8 @@ int cap_cache_check(unsigned long start, unsigned long end, unsigned int flags)
 	  * concerned here has
 	  *  appropriate permissions for cache calls
 	  */
-  	if (!(virtmem = cap_find(current, cap_match_cache,
-			 	 &args, CAP_TYPE_MAP_VIRTMEM)))
+  	if (!(virtmem = cap_find_mem(current, cap_match_cache, &args,
+				     CAP_TYPE_MAP_VIRTMEM, __pfn(start))))
 	return -ENOCAP;
 
 	return 0;
@@ -748,6 +942,13 @@ int cap_ipc_check(l4id_t to, l4id_t from,
 	return 0;
 }
 
+int cap_map_item_check(struct ktcb *from, struct ktcb *to,
+		       unsigned long phys, unsigned long virt,
+		       unsigned long npages, unsigned int flags)
+{
+	return 0;
+}
+
 int cap_map_check(struct ktcb *task, unsigned long phys, unsigned long virt,
 		  unsigned long npages, unsigned int flags)
 {
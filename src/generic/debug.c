@@ -6,13 +6,18 @@
  * Written by Bahadir Balban
  */
 #include <l4/lib/printk.h>
+#include <l4/lib/string.h>
 #include <l4/generic/debug.h>
+#include <l4/generic/space.h>
+#include <l4/api/container.h>
+#include <l4/api/errno.h>
 #include INC_SUBARCH(cpu.h)
+#include INC_ARCH(irq.h)
 #include <l4/generic/platform.h>
 
 #if defined (CONFIG_DEBUG_ACCOUNTING)
 
-struct system_accounting system_accounting;
+DECLARE_PERCPU(struct system_accounting, system_accounting);
 
 void system_accounting_print(struct system_accounting *sys_acc)
 {
@@ -46,6 +51,37 @@ void system_accounting_print(struct system_accounting *sys_acc)
 	printk("\nCache operations:\n");
 
 }
+
+/*
+ * Copies out the counters of the cpu in flags, optionally
+ * resetting them. Other cpus may move their counters while
+ * they are being read or reset, so a remote snapshot is only
+ * consistent per counter.
+ */
+int system_accounting_read(unsigned int flags, void *userbuf)
+{
+	unsigned int cpu = flags & CONTAINER_CONTROL_CPU_MASK;
+	struct system_accounting *acc;
+	unsigned long state;
+	int err;
+
+	if (cpu >= CONFIG_NCPU)
+		return -EINVAL;
+
+	if ((err = check_access((unsigned long)userbuf, sizeof(*acc),
+				MAP_USR_RW, 1)) < 0)
+		return err;
+
+	acc = &per_cpu_byid(system_accounting, cpu);
+
+	irq_local_disable_save(&state);
+	memcpy(userbuf, acc, sizeof(*acc));
+	if (flags & CONTAINER_CONTROL_RESET)
+		memset(acc, 0, sizeof(*acc));
+	irq_local_restore(state);
+
+	return 0;
+}
 #endif
 
 
@@ -9,12 +9,18 @@
 #include <l4/generic/debug.h>
 #include <l4/generic/platform.h>
 #include <l4/generic/tcb.h>
+#include <l4/generic/space.h>
 #include <l4/generic/irq.h>
+#include <l4/generic/time.h>
+#include <l4/generic/trace.h>
+#include <l4/generic/preempt.h>
 #include <l4/lib/mutex.h>
 #include <l4/lib/printk.h>
+#include <l4/lib/bit.h>
 #include <l4/api/errno.h>
 #include INC_PLAT(irq.h)
 #include INC_ARCH(exception.h)
+#include INC_ARCH(irq.h)
 
 /*
  * Registers a userspace thread as an irq handler.
@@ -42,6 +48,11 @@ int irq_register(struct ktcb *task, int notify_slot, l4id_t irq_index)
 	/* Setup the task and notify slot */
 	this_desc->task = task;
 	this_desc->task_notify_slot = notify_slot;
+	this_desc->flags = 0;
+#if defined(CONFIG_DEBUG_IRQ_LATENCY)
+	this_desc->latency_stamp = 0;
+	memset(&this_desc->latency, 0, sizeof(this_desc->latency));
+#endif
 
 	/* Setup irq desc waitqueue */
 	waitqueue_head_init(&this_desc->wqh_irq);
@@ -52,6 +63,196 @@ int irq_register(struct ktcb *task, int notify_slot, l4id_t irq_index)
 	return 0;
 }
 
+/*
+ * Unmasks all batched lines of task that were delivered since
+ * its last acknowledgement. Returns the number of lines.
+ */
+int irq_ack_lines(struct ktcb *task)
+{
+	struct irq_desc *desc;
+	unsigned long state;
+	int acked = 0;
+
+	irq_local_disable_save(&state);
+	for (int i = 0; i < IRQS_MAX; i++) {
+		desc = irq_desc_array + i;
+		if (desc->task == task &&
+		    (desc->flags & IRQ_DESC_MASKED)) {
+			desc->flags &= ~IRQ_DESC_MASKED;
+			irq_enable(i);
+			acked++;
+		}
+	}
+	irq_local_restore(state);
+
+	return acked;
+}
+
+/* Returns the mask of notify slots of all irqs registered to task */
+u32 irq_task_slots(struct ktcb *task)
+{
+	u32 slots = 0;
+
+	for (int i = 0; i < IRQS_MAX; i++)
+		if (irq_desc_array[i].task == task)
+			slots |= 1 << irq_desc_array[i].task_notify_slot;
+
+	return slots;
+}
+
+/* Unregisters irq_index and masks its line, which nobody takes now */
+static void irq_desc_release(l4id_t irq_index)
+{
+	struct irq_desc *desc = irq_desc_array + irq_index;
+
+	/* A batched line awaiting its ack is masked already */
+	if (!(desc->flags & IRQ_DESC_MASKED))
+		irq_disable(irq_index);
+
+	desc->task = 0;
+	desc->flags = 0;
+}
+
+/*
+ * Releases irq_index from task. Any pending ack of a batched line
+ * goes with it, so that the next registry starts with the line
+ * freshly enabled rather than held for an ack that never comes.
+ */
+int irq_release(struct ktcb *task, l4id_t irq_index)
+{
+	unsigned long state;
+	int err = 0;
+
+	if (irq_index >= IRQS_MAX || irq_index < 0)
+		return -ENOIRQ;
+
+	irq_local_disable_save(&state);
+	if (irq_desc_array[irq_index].task != task)
+		err = -ENOIRQ;
+	else
+		irq_desc_release(irq_index);
+	irq_local_restore(state);
+
+	return err;
+}
+
+/* Releases all irqs of a task that is going away */
+void irq_release_all(struct ktcb *task)
+{
+	unsigned long state;
+
+	irq_local_disable_save(&state);
+	for (int i = 0; i < IRQS_MAX; i++)
+		if (irq_desc_array[i].task == task)
+			irq_desc_release(i);
+	irq_local_restore(state);
+}
+
+#if defined(CONFIG_DEBUG_IRQ_LATENCY)
+
+/*
+ * Stamps a delivery to a registered thread. Only the oldest
+ * unserviced delivery is stamped, so coalesced irqs are charged
+ * from the first one. Called before nested irqs are enabled.
+ */
+static inline void irq_latency_stamp(struct irq_desc *desc)
+{
+	u32 now;
+
+	if (!desc->task || desc->latency_stamp)
+		return;
+
+	/* Zero means unstamped, lose a count instead */
+	if (!(now = clocksource_read()))
+		now = 1;
+
+	desc->latency_stamp = now;
+	desc->task->irq_latency_pending = 1;
+}
+
+static void irq_latency_record(struct irq_desc *desc, u32 now)
+{
+	struct irq_latency_stats *stats = &desc->latency;
+	u32 delta = now - desc->latency_stamp;
+	int bucket = 32 - __clz(delta);
+
+	desc->latency_stamp = 0;
+
+	if (bucket >= IRQ_LATENCY_BUCKETS)
+		bucket = IRQ_LATENCY_BUCKETS - 1;
+
+	if (!stats->count || delta < stats->min)
+		stats->min = delta;
+	if (delta > stats->max)
+		stats->max = delta;
+	stats->total += delta;
+	stats->count++;
+	stats->hist[bucket]++;
+}
+
+/*
+ * Called as task gets the cpu. Charges latency to all irqs
+ * delivered to it since it last ran. Irqs are disabled so
+ * that a nested irq can't stamp a line as it is recorded.
+ */
+void irq_latency_scheduled(struct ktcb *task)
+{
+	struct irq_desc *desc;
+	unsigned long state;
+	u32 now;
+
+	if (!task->irq_latency_pending)
+		return;
+
+	irq_local_disable_save(&state);
+	now = clocksource_read();
+	task->irq_latency_pending = 0;
+	for (int i = 0; i < IRQS_MAX; i++) {
+		desc = irq_desc_array + i;
+		if (desc->task == task && desc->latency_stamp)
+			irq_latency_record(desc, now);
+	}
+	irq_local_restore(state);
+}
+
+/*
+ * Copies out latency statistics of the irq in flags,
+ * optionally resetting them in the same snapshot.
+ */
+int irq_latency_read(unsigned int flags, void *userbuf)
+{
+	l4id_t irq_index = flags & CONTAINER_CONTROL_IRQ_MASK;
+	struct irq_desc *desc = irq_desc_array + irq_index;
+	struct irq_latency_stats stats;
+	unsigned long state;
+	int err;
+
+	if (irq_index >= IRQS_MAX)
+		return -ENOIRQ;
+
+	if ((err = check_access((unsigned long)userbuf, sizeof(stats),
+				MAP_USR_RW, 1)) < 0)
+		return err;
+
+	irq_local_disable_save(&state);
+	stats = desc->latency;
+	if (flags & CONTAINER_CONTROL_RESET)
+		memset(&desc->latency, 0, sizeof(desc->latency));
+	irq_local_restore(state);
+
+	stats.avg = stats.count ? (u32)(stats.total / stats.count) : 0;
+	stats.clock_hz = clocksource_freq();
+
+	memcpy(userbuf, &stats, sizeof(stats));
+
+	return 0;
+}
+
+#else /* End of CONFIG_DEBUG_IRQ_LATENCY */
+
+static inline void irq_latency_stamp(struct irq_desc *desc) { }
+
+#endif /* End of !CONFIG_DEBUG_IRQ_LATENCY */
 
 /* If there is cascading, enable it. */
 static inline void cascade_irq_chip(struct irq_chip *this_chip)
@@ -145,6 +346,14 @@ void do_irq(void)
 
 	system_account_irq();
 
+	trace(TRACE_IRQ_ENTER, irq_index);
+
+	/* Charge the interrupted context up to here */
+	if (in_user() && !in_nested_irq_context())
+		account_user_time();
+	else
+		account_kernel_time();
+
 	/*
 	 * Note, this can be easily done a few instructions
 	 * quicker by some immediate read/disable/enable_all().
@@ -153,6 +362,8 @@ void do_irq(void)
 	 */
 	irq_disable(irq_index);
 
+	irq_latency_stamp(this_irq);
+
 	/* Re-enable all irqs */
 	enable_irqs();
 
@@ -164,5 +375,17 @@ void do_irq(void)
 		BUG();
 	}
 
-	irq_enable(irq_index);
+	/* Batched lines stay masked until their thread acknowledges */
+	if (this_irq->flags & IRQ_DESC_BATCHED)
+		this_irq->flags |= IRQ_DESC_MASKED;
+	else
+		irq_enable(irq_index);
+
+	/* Thread was interrupted itself, it runs as soon as we return */
+	if (this_irq->task == current)
+		irq_latency_scheduled(current);
+
+	trace(TRACE_IRQ_EXIT, irq_index);
+
+	account_kernel_time();
 }
@@ -22,7 +22,14 @@ struct kernel_resources kernel_resources;
 
 pgd_table_t *pgd_alloc(void)
 {
-	return mem_cache_zalloc(kernel_resources.pgd_cache);
+	pgd_table_t *pgd;
+
+	/* Clearing a whole pgd shows up on every fork */
+	if ((pgd = mem_cache_alloc(kernel_resources.pgd_cache)) &&
+	    !IS_ERR(pgd))
+		clear_blocks(pgd, sizeof(*pgd));
+
+	return pgd;
 }
 
 pmd_table_t *pmd_cap_alloc(struct cap_list *clist)
@@ -159,6 +166,7 @@ int memcap_split(struct capability *cap, struct cap_list *cap_list,
 	new->end = cap->end;
 	new->start = end;
 	cap->end = start;
+	new->type = cap->type;
 	new->access = cap->access;
 
 	/* Add new one next to original cap */
@@ -183,6 +191,8 @@ int memcap_shrink(struct capability *cap, struct cap_list *cap_list,
 	} else
 		BUG();
 
+	cap_generation_bump();
+
 	return 0;
 }
 
@@ -205,7 +215,7 @@ int memcap_unmap_range(struct capability *cap,
 	/* Destroy needed? */
 	else if ((cap->start >= start) && (cap->end <= end))
 		/* Simply unlink it */
-		list_remove(&cap->list);
+		cap_list_remove(cap, cap_list);
 	else
 		BUG();
 
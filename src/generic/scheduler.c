@@ -18,11 +18,14 @@
 #include <l4/generic/debug.h>
 #include <l4/generic/irq.h>
 #include <l4/generic/tcb.h>
+#include <l4/generic/time.h>
+#include <l4/generic/trace.h>
 #include <l4/api/errno.h>
 #include <l4/api/kip.h>
 #include INC_SUBARCH(mm.h)
 #include INC_GLUE(mapping.h)
 #include INC_GLUE(init.h)
+#include INC_GLUE(ipi.h)
 #include INC_PLAT(platform.h)
 #include INC_ARCH(exception.h)
 #include INC_SUBARCH(irq.h)
@@ -123,6 +126,7 @@ void sched_init()
 	sched->rq_expired = &sched->sched_rq[1];
 	sched->prio_total = TASK_PRIO_TOTAL;
 	sched->idle_task = current;
+	sched->running = current;
 }
 
 /* Swap runnable and expired runqueues. */
@@ -187,6 +191,28 @@ static inline void sched_rq_remove_task(struct ktcb *task)
 	sched_unlock_runqueues(sched, irqflags);
 }
 
+#if defined (CONFIG_SMP_)
+/*
+ * A task was queued on another cpu. Tell that cpu to reschedule
+ * if the task should preempt what it runs, e.g. its idle task.
+ * This also wakes it up if it is halted with its tick stopped.
+ */
+static inline void sched_kick_cpu(struct ktcb *task)
+{
+	struct scheduler *sched = &per_cpu_byid(scheduler, task->affinity);
+	struct ktcb *running = sched->running;
+
+	if (task->affinity == smp_get_cpuid())
+		return;
+
+	if (running == sched->idle_task ||
+	    task->priority > running->priority)
+		smp_send_ipi(CPUID_TO_MASK(task->affinity), IPI_RESCHEDULE);
+}
+#else
+static inline void sched_kick_cpu(struct ktcb *task) { }
+#endif
+
 void sched_init_task(struct ktcb *task, int prio)
 {
 	link_init(&task->rq_list);
@@ -205,6 +231,7 @@ void sched_resume_sync(struct ktcb *task)
 	sched_rq_add_task(task, per_cpu_byid(scheduler,
 					     task->affinity).rq_runnable,
 					     1);
+	sched_kick_cpu(task);
 	schedule();
 }
 
@@ -220,8 +247,179 @@ void sched_resume_async(struct ktcb *task)
 	sched_rq_add_task(task, per_cpu_byid(scheduler,
 					     task->affinity).rq_runnable,
 					     1);
+	sched_kick_cpu(task);
+}
+
+/*
+ * Number of tasks other than idle queued on a cpu,
+ * including the one that is running.
+ */
+static inline int sched_nr_queued(struct scheduler *sched)
+{
+	int total = sched->rq_runnable->total + sched->rq_expired->total;
+
+	/* Idle task sits on the runnable queue while it runs */
+	if (sched->idle_task->rq)
+		total--;
+
+	return total;
+}
+
+/*
+ * Tells whether there is any task other than idle
+ * waiting to run on current cpu.
+ */
+int sched_has_runnable(void)
+{
+	return sched_nr_queued(&per_cpu(scheduler)) > 0;
+}
+
+#if defined (CONFIG_SMP_)
+
+/*
+ * Load balancing.
+ *
+ * Cpus that are short of work mark themselves on the balance
+ * request mask of a busier cpu, either when they go idle, or
+ * periodically by the busier cpu itself on its tick. The busier
+ * cpu then hands over its surplus tasks in schedule().
+ *
+ * Only the owner cpu ever removes tasks from its runqueues, so
+ * a task is never migrated while it is running, or while it is
+ * being selected to run.
+ */
+#define SCHED_BALANCE_TICKS		(CONFIG_SCHED_TICKS / 10)
+
+DECLARE_PERCPU(static unsigned int, balance_ticks);
+
+/* Cpu with most queued tasks, if it has any waiting to run */
+static int sched_find_busiest_cpu(void)
+{
+	int busiest = -1, max = 1, nr;
+
+	for (int cpu = 0; cpu < CONFIG_NCPU; cpu++) {
+		if (cpu == smp_get_cpuid())
+			continue;
+		if ((nr = sched_nr_queued(&per_cpu_byid(scheduler, cpu)))
+		    > max) {
+			max = nr;
+			busiest = cpu;
+		}
+	}
+	return busiest;
+}
+
+/* Cpu with least queued tasks, if it has less than us */
+static int sched_find_idlest_cpu(void)
+{
+	int idlest = -1, nr;
+	int min = sched_nr_queued(&per_cpu(scheduler)) - 1;
+
+	for (int cpu = 0; cpu < CONFIG_NCPU; cpu++) {
+		if (cpu == smp_get_cpuid())
+			continue;
+		if ((nr = sched_nr_queued(&per_cpu_byid(scheduler, cpu)))
+		    < min) {
+			min = nr;
+			idlest = cpu;
+		}
+	}
+	return idlest;
+}
+
+/* Called by the idle task before it halts the cpu */
+void sched_balance_idle(void)
+{
+	int cpu;
+
+	if ((cpu = sched_find_busiest_cpu()) >= 0)
+		per_cpu_byid(scheduler, cpu).balance_request |=
+			cpu_mask_self();
 }
 
+/* Called on every tick of current cpu */
+void sched_balance_tick(void)
+{
+	int cpu;
+
+	if (++per_cpu(balance_ticks) >= SCHED_BALANCE_TICKS) {
+		per_cpu(balance_ticks) = 0;
+		if ((cpu = sched_find_idlest_cpu()) >= 0)
+			per_cpu(scheduler).balance_request |=
+				CPUID_TO_MASK(cpu);
+	}
+
+	if (per_cpu(scheduler).balance_request)
+		need_resched = 1;
+}
+
+/*
+ * Finds a task on current cpu's runqueues that may migrate,
+ * preferring the ones that have expired their timeslice.
+ */
+static struct ktcb *sched_find_migratable(void)
+{
+	struct scheduler *sched = &per_cpu(scheduler);
+	struct runqueue *rqs[] = { sched->rq_expired, sched->rq_runnable };
+	struct ktcb *task, *found = 0;
+	unsigned long irqflags;
+
+	sched_lock_runqueues(sched, &irqflags);
+	for (int i = 0; i < 2 && !found; i++) {
+		list_foreach_struct(task, &rqs[i]->task_list, rq_list) {
+			if (task != current && !is_idle_task(task)) {
+				found = task;
+				break;
+			}
+		}
+	}
+	sched_unlock_runqueues(sched, irqflags);
+
+	return found;
+}
+
+/* Moves a queued task over to given cpu */
+static void sched_migrate_task(struct ktcb *task, int cpu)
+{
+	sched_rq_remove_task(task);
+	task->affinity = cpu;
+	sched_rq_add_task(task, per_cpu_byid(scheduler, cpu).rq_runnable,
+			  RQ_ADD_BEHIND);
+	sched_kick_cpu(task);
+}
+
+/* Hands over surplus tasks to cpus that asked for them */
+static void sched_balance_push(void)
+{
+	struct scheduler *sched = &per_cpu(scheduler);
+	unsigned int request = sched->balance_request;
+	struct ktcb *task;
+
+	sched->balance_request = 0;
+
+	for (int cpu = 0; cpu < CONFIG_NCPU; cpu++) {
+		if (!(request & CPUID_TO_MASK(cpu)) ||
+		    cpu == smp_get_cpuid())
+			continue;
+
+		/* Leave if it would not even out the load */
+		if (sched_nr_queued(sched) <=
+		    sched_nr_queued(&per_cpu_byid(scheduler, cpu)) + 1)
+			continue;
+
+		if (!(task = sched_find_migratable()))
+			break;
+
+		sched_migrate_task(task, cpu);
+	}
+}
+
+#else /* End of CONFIG_SMP_ */
+
+static inline void sched_balance_push(void) { }
+
+#endif /* End of !CONFIG_SMP_ */
+
 /*
  * Takes all the action that will make a task sleep
  * in the scheduler. If the task is woken up before
@@ -280,6 +478,11 @@ static inline void context_switch(struct ktcb *next)
 
 	system_account_context_switch();
 
+	trace(TRACE_SCHED_SWITCH, next->tid);
+
+	/* Charge the outgoing thread up to the switch */
+	account_kernel_time();
+
 	/* Flush caches and everything */
 	BUG_ON(!current);
 	BUG_ON(!current->space);
@@ -292,6 +495,9 @@ static inline void context_switch(struct ktcb *next)
 	/* Update utcb region for next task */
 	task_update_utcb(next);
 
+	/* Irqs waiting on next are serviced from here on */
+	irq_latency_scheduled(next);
+
 	/* Switch context */
 	arch_context_switch(cur, next);
 
@@ -477,6 +683,10 @@ void schedule()
 			sched_suspend_async();
 	}
 
+	/* Hand over tasks to cpus that are short of work */
+	if (per_cpu(scheduler).balance_request)
+		sched_balance_push();
+
 	/* Hint scheduler to run idle asap to free task */
 	if (current->flags & TASK_EXITED) {
 		current->flags &= ~TASK_EXITED;
@@ -491,6 +701,7 @@ void schedule()
 
 	/* Finish */
 	disable_irqs();
+	per_cpu(scheduler).running = next;
 	preempt_enable();
 	context_switch(next);
 }
@@ -28,6 +28,9 @@ void address_space_attach(struct ktcb *tcb, struct address_space *space)
 {
 	tcb->space = space;
 	space->ktcb_refs++;
+
+	/* Cached caps came from the old space */
+	cap_cache_flush(&tcb->cap_cache);
 }
 
 struct address_space *address_space_find(l4id_t spid)
@@ -8,6 +8,8 @@
 #include <l4/generic/scheduler.h>
 #include <l4/generic/container.h>
 #include <l4/generic/preempt.h>
+#include <l4/generic/notify.h>
+#include <l4/generic/irq.h>
 #include <l4/generic/space.h>
 #include <l4/lib/idpool.h>
 #include <l4/api/ipc.h>
@@ -42,6 +44,10 @@ void tcb_init(struct ktcb *new)
 	waitqueue_head_init(&new->wqh_send);
 	waitqueue_head_init(&new->wqh_recv);
 	waitqueue_head_init(&new->wqh_pager);
+	waitqueue_head_init(&new->wqh_notify);
+	link_init(&new->notify_timer);
+
+	cap_cache_flush(&new->cap_cache);
 }
 
 struct ktcb *tcb_alloc_init(l4id_t cid)
@@ -73,11 +79,18 @@ void tcb_delete_pager(struct ktcb *tcb)
 	struct cap_list *pager_cap_list =
 		&tcb->container->pager->cap_list;
 
+	/* A timed wait cut short by destruction may still be listed */
+	notify_timer_cancel(tcb);
+
+	/* Irqs must neither reach us nor stay masked for our ack */
+	irq_release_all(tcb);
+
 	/* Sanity checks first */
 	BUG_ON(!is_page_aligned(tcb));
 	BUG_ON(tcb->wqh_pager.sleepers > 0);
 	BUG_ON(tcb->wqh_send.sleepers > 0);
 	BUG_ON(tcb->wqh_recv.sleepers > 0);
+	BUG_ON(tcb->wqh_notify.sleepers > 0);
 	BUG_ON(tcb->affinity != current->affinity);
 	BUG_ON(tcb->state != TASK_INACTIVE);
 	BUG_ON(!list_empty(&tcb->rq_list));
@@ -123,11 +136,18 @@ void tcb_delete(struct ktcb *tcb)
 {
 	struct ktcb *pager = tcb->pager;
 
+	/* A timed wait cut short by destruction may still be listed */
+	notify_timer_cancel(tcb);
+
+	/* Irqs must neither reach us nor stay masked for our ack */
+	irq_release_all(tcb);
+
 	/* Sanity checks first */
 	BUG_ON(!is_page_aligned(tcb));
 	BUG_ON(tcb->wqh_pager.sleepers > 0);
 	BUG_ON(tcb->wqh_send.sleepers > 0);
 	BUG_ON(tcb->wqh_recv.sleepers > 0);
+	BUG_ON(tcb->wqh_notify.sleepers > 0);
 	BUG_ON(tcb->affinity != current->affinity);
 	BUG_ON(tcb->state != TASK_INACTIVE);
 	BUG_ON(!list_empty(&tcb->rq_list));
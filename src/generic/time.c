@@ -7,15 +7,22 @@
 #include <l4/types.h>
 #include <l4/lib/mutex.h>
 #include <l4/lib/printk.h>
+#include <l4/lib/spinlock.h>
 #include <l4/generic/irq.h>
 #include <l4/generic/scheduler.h>
 #include <l4/generic/time.h>
 #include <l4/generic/preempt.h>
 #include <l4/generic/space.h>
+#include <l4/generic/notify.h>
 #include INC_ARCH(exception.h)
+#include INC_ARCH(irq.h)
+#include INC_SUBARCH(mmu_ops.h)
 #include <l4/api/syscall.h>
 #include <l4/api/errno.h>
+#include INC_API(kip.h)
 #include INC_GLUE(ipi.h)	/*FIXME: Remove this */
+#include INC_GLUE(smp.h)
+#include INC_PLAT(platform.h)
 
 /* TODO:
  * 1) Add RTC support.
@@ -30,79 +37,197 @@ static inline void increase_jiffies(void)
 	jiffies++;
 }
 
+/* Counts are converted to usecs shifted by this much */
+#define CLOCKSOURCE_SHIFT		20
+#define CLOCKSOURCE_MULT(freq)		(((u64)1000000 << CLOCKSOURCE_SHIFT) \
+					 / (freq))
+#define USEC_PER_SEC_SHIFTED		((u64)1000000 << CLOCKSOURCE_SHIFT)
+
+static u32 jiffies_read(void)
+{
+	return jiffies;
+}
+
+/* Used until the platform registers a finer clock source */
+static struct clocksource clocksource_jiffies = {
+	.name = "jiffies",
+	.read = jiffies_read,
+	.freq = CONFIG_SCHED_TICKS,
+	.mult = CLOCKSOURCE_MULT(CONFIG_SCHED_TICKS),
+};
 
 /* Internal representation of time since epoch */
 struct time_info {
-	int reader;
-	u32 thz;	/* Ticks in this hertz so far */
-	u64 sec;	/* Seconds so far */
+	struct clocksource *clock;
+	u32 cycle_last;		/* Clock count at last update */
+	u64 usec_shifted;	/* Shifted usecs in this second so far */
+	u32 sec;		/* Seconds so far */
+};
+
+static struct time_info systime = {
+	.clock = &clocksource_jiffies,
 };
 
-static struct time_info systime = { 0 };
+static inline u64 clock_cycles_to_shifted(struct clocksource *cs,
+					  u32 cycles)
+{
+	return (u64)cycles * cs->mult;
+}
 
 /*
- * A very basic (probably erroneous)
- * rule-of-thumb time calculation.
+ * Advance system time by the clock counts that passed since
+ * last update, and publish it to the time page. Only the timer
+ * owner cpu calls this, so there is no locking among writers.
  */
 void update_system_time(void)
 {
-	/* Did we interrupt a reader? Tell it to retry */
-	if (systime.reader)
-		systime.reader = 0;
+	struct clocksource *cs = systime.clock;
+	u32 now = cs->read();
 
-	/* Increase just like jiffies, but reset every second */
-	systime.thz++;
+	time_page.seq++;
+	dmb();
 
-	/*
-	 * On every 1 second of timer ticks, increase seconds
-	 *
-	 * TODO: Investigate: how do we make sure timer_irq is
-	 * called SCHED_TICKS times per second?
-	 */
-	if (systime.thz == CONFIG_SCHED_TICKS) {
-		systime.thz = 0;
+	systime.usec_shifted +=
+		clock_cycles_to_shifted(cs, now - systime.cycle_last);
+	systime.cycle_last = now;
+
+	while (systime.usec_shifted >= USEC_PER_SEC_SHIFTED) {
+		systime.usec_shifted -= USEC_PER_SEC_SHIFTED;
 		systime.sec++;
 	}
+
+	time_page.sec = systime.sec;
+	time_page.usec = (u32)(systime.usec_shifted >> CLOCKSOURCE_SHIFT);
+
+	dmb();
+	time_page.seq++;
+}
+
+/*
+ * Thread cpu times are charged from the clock source at each
+ * kernel entry, exit and context switch, rather than a whole
+ * tick at a time, so threads that block before a tick are
+ * also accounted for.
+ */
+DECLARE_PERCPU(static u32, cputime_stamp);
+
+static inline u32 cputime_delta(void)
+{
+	u32 now = systime.clock->read();
+	u32 delta = now - per_cpu(cputime_stamp);
+
+	per_cpu(cputime_stamp) = now;
+	return delta;
+}
+
+/*
+ * Time since last accounting was spent in userland. Irqs
+ * are disabled as a nested irq would also move the stamp.
+ */
+void account_user_time(void)
+{
+	unsigned long irqstate;
+
+	irq_local_disable_save(&irqstate);
+	current->user_time += cputime_delta();
+	irq_local_restore(irqstate);
+}
+
+/* Time since last accounting was spent in kernel */
+void account_kernel_time(void)
+{
+	unsigned long irqstate;
+
+	irq_local_disable_save(&irqstate);
+	current->kernel_time += cputime_delta();
+	irq_local_restore(irqstate);
+}
+
+u64 cputime_to_usec(u64 counts)
+{
+	/* Split to avoid overflowing the shifted product */
+	return (counts / systime.clock->freq) * 1000000 +
+	       (clock_cycles_to_shifted(systime.clock,
+					counts % systime.clock->freq)
+		>> CLOCKSOURCE_SHIFT);
+}
+
+/* Raw count of the current clock source, e.g. for timestamps */
+u32 clocksource_read(void)
+{
+	return systime.clock->read();
+}
+
+u32 clocksource_freq(void)
+{
+	return systime.clock->freq;
+}
+
+/*
+ * Switch over to a new clock source. Time so far
+ * is accumulated with the old one.
+ */
+void clocksource_register(struct clocksource *cs)
+{
+	update_system_time();
+
+	cs->mult = CLOCKSOURCE_MULT(cs->freq);
+	systime.cycle_last = cs->read();
+	systime.clock = cs;
+
+	/* Cpu time stamps were taken with the old one */
+	for (int cpu = 0; cpu < CONFIG_NCPU; cpu++)
+		per_cpu_byid(cputime_stamp, cpu) = systime.cycle_last;
+
+	printk("%s: Using %s as clock source.\n", __KERNELNAME__, cs->name);
 }
 
 /* Read system time */
 int sys_time(struct timeval *tv, int set)
 {
-	int retries = 20;
+	struct clocksource *cs;
+	u32 seq, sec, usec;
 	int err;
 
 	if ((err = check_access((unsigned long)tv, sizeof(*tv),
 				MAP_USR_RW, 1)) < 0)
 		return err;
 
-	/* Get time */
-	if (!set) {
-		while(retries > 0) {
-			systime.reader = 1;
-			tv->tv_sec = systime.sec;
-			tv->tv_usec = 1000000 * systime.thz / CONFIG_SCHED_TICKS;
-
-			retries--;
-			if (systime.reader)
-				break;
-		}
-
-		/*
-		 * No need to reset reader since it will be reset
-		 * on next timer. If no retries return busy.
-		 */
-		if (!retries)
-			return -EBUSY;
-		else
-			return 0;
-
 	/* Set */
-	} else {
+	if (set) {
 		/*
 		 * Setting the time not supported yet.
 		 */
 		return -ENOSYS;
 	}
+
+	/*
+	 * Get time. Unlike the time page, this also adds
+	 * clock counts since last update.
+	 */
+	do {
+		seq = time_page.seq;
+		dmb();
+
+		cs = systime.clock;
+		sec = time_page.sec;
+		usec = time_page.usec +
+		       (u32)(clock_cycles_to_shifted(cs, cs->read() -
+						     systime.cycle_last)
+			     >> CLOCKSOURCE_SHIFT);
+
+		dmb();
+	} while ((seq & 1) || seq != time_page.seq);
+
+	while (usec >= 1000000) {
+		usec -= 1000000;
+		sec++;
+	}
+
+	tv->tv_sec = sec;
+	tv->tv_usec = usec;
+
+	return 0;
 }
 
 void update_process_times(void)
@@ -121,15 +246,6 @@ void update_process_times(void)
 			BUG();
 	}
 
-	/*
-	 * These are TASK_RUNNABLE times, i.e. exludes sleeps
-	 * In the future we may use timestamps for accuracy
-	 */
-	if (in_kernel())
-		cur->kernel_time++;
-	else
-		cur->user_time++;
-
 	cur->ticks_left--;
 	cur->sched_granule--;
 
@@ -140,16 +256,108 @@ void update_process_times(void)
 	/* Task has expired its schedule granularity */
 	if (!cur->sched_granule)
 		need_resched = 1;
+
+	/* Check if load needs spreading to other cpus */
+	sched_balance_tick();
+}
+
+#if defined (CONFIG_SCHED_TICKLESS)
+
+/*
+ * Dynamic ticks.
+ *
+ * The primary cpu owns the platform timer and relays each tick
+ * to other cpus with a timer ipi. An idle cpu marks itself in
+ * nohz_idle_mask and stops receiving these. Once all cpus are
+ * idle, the primary stops the periodic timer as well, and arms a
+ * one shot in its place, due at the earliest timed notify wait or
+ * within the timer range if there is none.
+ */
+#define TICK_NOHZ_MAX_TICKS		CONFIG_SCHED_TICKS
+
+static DECLARE_SPINLOCK(nohz_lock);
+static volatile unsigned int nohz_idle_mask;
+static int nohz_timer_stopped;
+
+/* Called by idle task with irqs disabled, before halting the cpu */
+void tick_nohz_idle_enter(void)
+{
+	unsigned int ticks;
+
+	spin_lock(&nohz_lock);
+
+	nohz_idle_mask |= cpu_mask_self();
+
+	/* Timer owner may stop the tick once everybody is idle */
+	if (smp_get_cpuid() == 0 && nohz_idle_mask == cpu_mask_all()) {
+		ticks = notify_timer_next();
+		if (!ticks || ticks > TICK_NOHZ_MAX_TICKS)
+			ticks = TICK_NOHZ_MAX_TICKS;
+		platform_timer_oneshot(ticks);
+		nohz_timer_stopped = 1;
+	}
+
+	spin_unlock(&nohz_lock);
+}
+
+/* Called by idle task with irqs disabled, after the cpu wakes up */
+void tick_nohz_idle_exit(void)
+{
+	unsigned int ticks;
+
+	spin_lock(&nohz_lock);
+
+	nohz_idle_mask &= ~cpu_mask_self();
+
+	if (nohz_timer_stopped) {
+		if (smp_get_cpuid() == 0) {
+			/* Catch up with ticks that passed in sleep */
+			ticks = platform_timer_periodic();
+			jiffies += ticks;
+			update_system_time();
+			notify_timer_run();
+			nohz_timer_stopped = 0;
+		}
+#if defined (CONFIG_SMP_)
+		else {
+			/* Wake up the timer owner to restart the tick */
+			smp_send_ipi(CPUID_TO_MASK(0), IPI_TIMER_EVENT);
+		}
+#endif
+	}
+
+	spin_unlock(&nohz_lock);
 }
 
+#if defined (CONFIG_SMP_)
+/* Relay the tick to other cpus, skipping the idle ones */
+static inline void tick_relay(void)
+{
+	unsigned int mask = cpu_mask_others() & ~nohz_idle_mask;
+
+	if (mask)
+		smp_send_ipi(mask, IPI_TIMER_EVENT);
+}
+#endif
+
+#elif defined (CONFIG_SMP_) /* End of CONFIG_SCHED_TICKLESS */
+
+static inline void tick_relay(void)
+{
+	smp_send_ipi(cpu_mask_others(), IPI_TIMER_EVENT);
+}
+
+#endif /* End of !CONFIG_SCHED_TICKLESS */
+
 int do_timer_irq(void)
 {
 	increase_jiffies();
+	notify_timer_run();
 	update_process_times();
 	update_system_time();
 
 #if defined (CONFIG_SMP_)
-	smp_send_ipi(cpu_mask_others(), IPI_TIMER_EVENT);
+	tick_relay();
 #endif
 
 	return IRQ_HANDLED;
@@ -161,4 +369,3 @@ int secondary_timer_irq(void)
 	update_process_times();
 	return IRQ_HANDLED;
 }
-
@@ -0,0 +1,107 @@
+/*
+ * Per-cpu kernel event trace rings.
+ *
+ * Copyright (C) 2010 B Labs Ltd.
+ */
+#include <l4/lib/string.h>
+#include <l4/generic/trace.h>
+#include <l4/generic/tcb.h>
+#include <l4/generic/time.h>
+#include <l4/generic/space.h>
+#include <l4/api/errno.h>
+#include INC_GLUE(memory.h)
+#include INC_GLUE(memlayout.h)
+#include INC_GLUE(mapping.h)
+#include INC_GLUE(smp.h)
+#include INC_ARCH(irq.h)
+#include INC_SUBARCH(mmu_ops.h)
+
+#if defined(CONFIG_DEBUG_TRACE)
+
+#define TRACE_BUFFER_SIZE	align_up(sizeof(struct trace_buffer), PAGE_SIZE)
+
+/* Rings are padded to whole pages so they can be mapped out alone */
+union trace_pages {
+	struct trace_buffer buf;
+	char pages[TRACE_BUFFER_SIZE];
+};
+
+DECLARE_PERCPU(static union trace_pages, trace_pages) ALIGN(PAGE_SIZE);
+
+u32 trace_mask;
+
+/*
+ * Appends an event to this cpu's ring, overwriting the oldest.
+ * Only this cpu writes its ring, so disabling irqs is enough to
+ * keep nested events from interleaving.
+ */
+void trace_event(unsigned int type, u32 arg)
+{
+	struct trace_buffer *tb = &per_cpu(trace_pages).buf;
+	struct trace_event *event;
+	unsigned long state;
+
+	irq_local_disable_save(&state);
+
+	event = &tb->events[tb->head & (TRACE_EVENTS - 1)];
+	event->stamp = clocksource_read();
+	event->type = type;
+	event->tid = current->tid;
+	event->arg = arg;
+
+	/* Event must be complete before readers see the new head */
+	dmb();
+	tb->head++;
+
+	irq_local_restore(state);
+}
+
+void trace_init(void)
+{
+	struct trace_buffer *tb;
+
+	for (int cpu = 0; cpu < CONFIG_NCPU; cpu++) {
+		tb = &per_cpu_byid(trace_pages, cpu).buf;
+		tb->magic = TRACE_MAGIC;
+		tb->cpu = cpu;
+	}
+}
+
+/*
+ * Sets the categories to record and returns the old set.
+ * The clock source may have changed since boot, so its
+ * rate is refreshed for readers too.
+ */
+u32 trace_set_mask(u32 mask)
+{
+	u32 old = trace_mask;
+
+	mask &= TRACE_MASK_ALL;
+	for (int cpu = 0; cpu < CONFIG_NCPU; cpu++) {
+		per_cpu_byid(trace_pages, cpu).buf.mask = mask;
+		per_cpu_byid(trace_pages, cpu).buf.clock_hz =
+			clocksource_freq();
+	}
+	trace_mask = mask;
+
+	return old;
+}
+
+/* Maps the ring of a cpu read-only to the caller at vaddr */
+int trace_map(unsigned int cpu, unsigned long vaddr)
+{
+	if (cpu >= CONFIG_NCPU)
+		return -EINVAL;
+
+	if (!is_page_aligned(vaddr) ||
+	    is_kernel_address(vaddr) ||
+	    is_kernel_address(vaddr + TRACE_BUFFER_SIZE - 1))
+		return -EINVAL;
+
+	return add_mapping_space(virt_to_phys(&per_cpu_byid(trace_pages,
+							    cpu)),
+				 vaddr, TRACE_BUFFER_SIZE, MAP_USR_RO,
+				 current->space);
+}
+
+#endif /* End of CONFIG_DEBUG_TRACE */
@@ -11,15 +11,16 @@ void system_measure_syscall_end(unsigned long swi_address)
 {
 	volatile u64 cnt = perfmon_read_cyccnt() * CYCLES_PER_COUNTER_TICKS;
 	unsigned int call_offset = (swi_address & 0xFF) >> 2;
+	struct system_accounting *acc = &per_cpu(system_accounting);
 
 	/* Number of syscalls */
 	u64 call_count =
-		*(((u64 *)&system_accounting.syscalls) + call_offset);
+		*(((u64 *)&acc->syscalls) + call_offset);
 
 	/* System call timing structure */
 	struct syscall_timing *st =
 		(struct syscall_timing *)
-			&system_accounting.syscall_timings + call_offset;
+			&acc->syscall_timings + call_offset;
 
 	/* Set min */
 	if (st->min == 0)
@@ -37,7 +38,7 @@ void system_measure_syscall_end(unsigned long swi_address)
 	st->avg = st->total / call_count;
 
 	/* Update total */
-	system_accounting.syscall_timings.all_total += cnt;
+	acc->syscall_timings.all_total += cnt;
 }
 
 #endif
@@ -15,6 +15,7 @@
 #include <l4/generic/bootmem.h>
 #include <l4/generic/resource.h>
 #include <l4/generic/container.h>
+#include <l4/generic/trace.h>
 #include INC_ARCH(linker.h)
 #include INC_ARCH(asm.h)
 #include INC_SUBARCH(mm.h)
@@ -86,6 +87,8 @@ void kip_init()
 
 	add_boot_mapping(virt_to_phys(&kip), USER_KIP_PAGE, PAGE_SIZE,
 			 MAP_USR_RO);
+	add_boot_mapping(virt_to_phys(&time_page), USER_TIME_PAGE, PAGE_SIZE,
+			 MAP_USR_RO);
 	printk("%s: Kernel built on %s, %s\n", __KERNELNAME__,
 	       kip.kdesc.date, kip.kdesc.time);
 }
@@ -118,6 +121,9 @@ void init_finalize(void)
 	dmb();
 #endif
 
+	/* From here on, printk output is buffered */
+	printk_async_start();
+
 	sched_resume_async(current);
 	idle_task();
 }
@@ -191,6 +197,12 @@ void start_kernel(void)
 	/* Initialise system call page */
 	syscall_init();
 
+	/* Set up per-cpu windows used by long ipc copies */
+	copy_window_init();
+
+	/* Set up trace rings, if enabled */
+	trace_init();
+
 	/* Init performance monitor, if enabled */
 	perfmon_init();
 
@@ -12,11 +12,12 @@
 #include <l4/lib/printk.h>
 #include <l4/drivers/irq/gic/gic.h>
 #include <l4/generic/time.h>
+#include <l4/generic/scheduler.h>
 
 /* This should be in a file something like exception.S */
 int ipi_handler(struct irq_desc *desc)
 {
-	int ipi_event = (desc - irq_desc_array) / sizeof(struct irq_desc);
+	int ipi_event = desc - irq_desc_array;
 
 //	printk("CPU%d: entered IPI%d\n", smp_get_cpuid(),
 //	       (desc - irq_desc_array) / sizeof(struct irq_desc));
@@ -26,6 +27,10 @@ int ipi_handler(struct irq_desc *desc)
 		// printk("CPU%d: Handling timer ipi\n", smp_get_cpuid());
 		secondary_timer_irq();
 		break;
+	case IPI_RESCHEDULE:
+		/* A task was queued here, schedule on irq return */
+		need_resched = 1;
+		break;
 	default:
 		printk("CPU%d: IPI with no meaning: %d\n",
 		       smp_get_cpuid(), ipi_event);
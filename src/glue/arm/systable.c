@@ -9,6 +9,8 @@
 #include <l4/generic/scheduler.h>
 #include <l4/generic/debug.h>
 #include <l4/generic/tcb.h>
+#include <l4/generic/time.h>
+#include <l4/generic/trace.h>
 #include <l4/api/errno.h>
 #include INC_GLUE(memlayout.h)
 #include INC_GLUE(syscall.h)
@@ -162,6 +164,8 @@ int syscall(syscall_context_t *regs, unsigned long swi_addr)
 {
 	int ret = 0;
 
+	account_user_time();
+
 	/* Check if genuine system call, coming from the syscall page */
 	if ((swi_addr & ARM_SYSCALL_PAGE) == ARM_SYSCALL_PAGE) {
 		/* Check within syscall offset boundary */
@@ -175,9 +179,13 @@ int syscall(syscall_context_t *regs, unsigned long swi_addr)
 			/* Start measure syscall timing, if enabled */
 			system_measure_syscall_start();
 
+			trace(TRACE_SYSCALL_ENTER, swi_addr & 0xFF);
+
 			/* Quick jump, rather than compare each */
 			ret = (*syscall_table[(swi_addr & 0xFF) >> 2])(regs);
 
+			trace(TRACE_SYSCALL_EXIT, ret);
+
 			/* End measure syscall timing, if enabled */
 			system_measure_syscall_end(swi_addr);
 
@@ -198,6 +206,8 @@ int syscall(syscall_context_t *regs, unsigned long swi_addr)
 		sched_suspend_sync();
 	}
 
+	account_kernel_time();
+
 	return ret;
 }
 
@@ -35,6 +35,10 @@
 typedef unsigned int word_t;
 
 extern void putc(const char c);
+
+#if defined(CONFIG_PRINTK_ASYNC)
+extern int printk_async;
+#endif
 extern int print_tid (word_t val, word_t width, word_t precision, int adjleft);
 
 
@@ -443,6 +447,24 @@ int printk(char *format, ...)
 
     va_start(args, format);
 
+#if defined(CONFIG_PRINTK_ASYNC)
+    /*
+     * Buffered output goes to this cpu's own ring, so only
+     * local irqs need to be kept out for lines to stay whole.
+     */
+    if (printk_async) {
+	irq_local_disable_save(&irqstate);
+	i = do_printk(format, args);
+	irq_local_restore(irqstate);
+
+	va_end(args);
+
+	/* Push out what the uart takes without waiting */
+	printk_drain();
+	return i;
+    }
+#endif
+
     spin_lock_irq(&printk_lock, &irqstate);
     i = do_printk(format, args);
     spin_unlock_irq(&printk_lock, irqstate);
@@ -4,10 +4,199 @@
  * Copyright (C) 2007 Bahadir Balban
  */
 #include INC_PLAT(uart.h)
+#include INC_PLAT(offsets.h)
+#include <l4/lib/printk.h>
 
-void putc(char c)
+static void uart_putc(char c)
 {
 	if (c == '\n')
 		uart_tx_char(PLATFORM_CONSOLE_VBASE, '\r');
 	uart_tx_char(PLATFORM_CONSOLE_VBASE, c);
 }
+
+#if !defined(CONFIG_PRINTK_ASYNC)
+
+void putc(char c)
+{
+	uart_putc(c);
+}
+
+#else /* CONFIG_PRINTK_ASYNC */
+
+#include <l4/lib/spinlock.h>
+#include <l4/lib/string.h>
+#include <l4/lib/math.h>
+#include <l4/generic/space.h>
+#include <l4/api/container.h>
+#include <l4/api/errno.h>
+#include INC_GLUE(smp.h)
+#include INC_SUBARCH(cpu.h)
+#include INC_SUBARCH(mmu_ops.h)
+
+#define PRINTK_RING_SIZE	SZ_16K
+
+/*
+ * Kernel output of a cpu. printk writes at head and the console
+ * takes bytes from tail, both on the owning cpu with irqs off.
+ * The ring also serves as that cpu's log for userspace.
+ */
+struct printk_ring {
+	volatile u32 head;
+	u32 tail;
+	int cr_sent;		/* '\r' of a '\n' at tail is out */
+	char data[PRINTK_RING_SIZE];
+};
+
+DECLARE_PERCPU(static struct printk_ring, printk_ring);
+
+/* Serializes cpus on the console uart */
+static DECLARE_SPINLOCK(console_lock);
+
+/*
+ * Output is synchronous until the kernel starts scheduling, so
+ * boot messages are not held back, and again after a panic.
+ */
+int printk_async;
+
+void printk_async_start(void)
+{
+	printk_async = 1;
+}
+
+void putc(char c)
+{
+	struct printk_ring *ring = &per_cpu(printk_ring);
+
+	if (!printk_async) {
+		uart_putc(c);
+		return;
+	}
+
+	ring->data[ring->head & (PRINTK_RING_SIZE - 1)] = c;
+
+	/* Byte must be in place before log readers see it */
+	dmb();
+	ring->head++;
+}
+
+/*
+ * Moves bytes of this cpu's ring to the console for as long as
+ * the uart takes them without waiting. Returns nonzero if there
+ * are bytes left. Bytes that printk overwrote before they went
+ * out are skipped.
+ */
+int printk_drain(void)
+{
+	struct printk_ring *ring = &per_cpu(printk_ring);
+	unsigned long state;
+	int pending;
+	char c;
+
+	spin_lock_irq(&console_lock, &state);
+
+	if (ring->head - ring->tail > PRINTK_RING_SIZE) {
+		ring->tail = ring->head - PRINTK_RING_SIZE;
+		ring->cr_sent = 0;
+	}
+
+	while (ring->tail != ring->head &&
+	       !uart_tx_full(PLATFORM_CONSOLE_VBASE)) {
+		c = ring->data[ring->tail & (PRINTK_RING_SIZE - 1)];
+
+		if (c == '\n' && !ring->cr_sent) {
+			uart_tx_char(PLATFORM_CONSOLE_VBASE, '\r');
+			ring->cr_sent = 1;
+			continue;
+		}
+
+		uart_tx_char(PLATFORM_CONSOLE_VBASE, c);
+		ring->cr_sent = 0;
+		ring->tail++;
+	}
+
+	pending = ring->tail != ring->head;
+
+	spin_unlock_irq(&console_lock, state);
+
+	return pending;
+}
+
+/*
+ * Called on BUG(), so that buffered output and the BUG
+ * message reach the console even though this cpu never
+ * gets to idle again.
+ */
+void printk_panic(void)
+{
+	if (!printk_async)
+		return;
+
+	while (printk_drain())
+		;
+
+	printk_async = 0;
+}
+
+/*
+ * Copies a cpu's log from log->pos on to the caller. Other cpus
+ * keep printing meanwhile, so the copy is retried if its start
+ * got overwritten while it was taken.
+ */
+int printk_log_read(unsigned int flags, void *userbuf)
+{
+	unsigned int cpu = flags & CONTAINER_CONTROL_CPU_MASK;
+	struct kernel_log *log = userbuf;
+	struct printk_ring *ring;
+	u32 pos, size, head, skipped, n, offset, chunk;
+	int err;
+
+	if (cpu >= CONFIG_NCPU)
+		return -EINVAL;
+
+	if ((err = check_access((unsigned long)log, sizeof(*log),
+				MAP_USR_RW, 1)) < 0)
+		return err;
+
+	size = log->size;
+	if (size > PRINTK_RING_SIZE)
+		size = PRINTK_RING_SIZE;
+	if ((err = check_access((unsigned long)log->data, size,
+				MAP_USR_RW, 1)) < 0)
+		return err;
+
+	ring = &per_cpu_byid(printk_ring, cpu);
+	pos = log->pos;
+	skipped = 0;
+
+	do {
+		head = ring->head;
+		dmb();
+
+		/* A position past the head has nothing to read yet */
+		if ((int)(head - pos) < 0)
+			pos = head;
+
+		/* Anything older than a ring's worth is gone */
+		if (head - pos > PRINTK_RING_SIZE) {
+			skipped += head - PRINTK_RING_SIZE - pos;
+			pos = head - PRINTK_RING_SIZE;
+		}
+
+		n = min(head - pos, size);
+		offset = pos & (PRINTK_RING_SIZE - 1);
+		chunk = min(n, PRINTK_RING_SIZE - offset);
+
+		memcpy(log->data, &ring->data[offset], chunk);
+		memcpy(log->data + chunk, ring->data, n - chunk);
+
+		dmb();
+	} while (ring->head - pos > PRINTK_RING_SIZE);
+
+	log->pos = pos + n;
+	log->size = n;
+	log->skipped = skipped;
+
+	return 0;
+}
+
+#endif /* CONFIG_PRINTK_ASYNC */
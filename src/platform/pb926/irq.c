@@ -101,6 +101,19 @@ static int platform_mouse_user_handler(struct irq_desc *desc)
 	return 0;
 }
 
+/*
+ * Handler for userspace devices that the kernel does not know
+ * how to quiet. Their lines are always batched, so they stay
+ * masked until the thread has served the device and acks.
+ */
+static int platform_batched_user_handler(struct irq_desc *desc)
+{
+	desc->flags |= IRQ_DESC_BATCHED;
+
+	irq_thread_notify(desc);
+	return 0;
+}
+
 /*
  * Built-in irq handlers initialised at compile time.
  * Else register with register_irq()
@@ -126,6 +139,16 @@ struct irq_desc irq_desc_array[IRQS_MAX] = {
 		.chip = &irq_chip_array[1],
 		.handler = platform_mouse_user_handler,
 	},
+	[IRQ_UART1] = {
+		.name = "Uart1",
+		.chip = &irq_chip_array[0],
+		.handler = platform_batched_user_handler,
+	},
+	[IRQ_CLCD0] = {
+		.name = "Clcd0",
+		.chip = &irq_chip_array[0],
+		.handler = platform_batched_user_handler,
+	},
 };
 
 
@@ -7,6 +7,7 @@
 #include <l4/generic/space.h>
 #include <l4/generic/irq.h>
 #include <l4/generic/bootmem.h>
+#include <l4/generic/time.h>
 #include INC_ARCH(linker.h)
 #include INC_SUBARCH(mm.h)
 #include INC_SUBARCH(mmu_ops.h)
@@ -64,13 +65,98 @@ void init_platform_console(void)
  * incase any other timer is needed we need to map it
  * to userspace or kernel space as needed
  */
+/* 1 Mhz means can tick up to 1,000,000 times a second */
+#define PLATFORM_TIMER_TICK_LOAD	(1000000 / CONFIG_SCHED_TICKS)
+
+/* Secondary timer on TIMER0 block free runs as the clock source */
+static u32 platform_clock_read(void)
+{
+	/* Timer counts down */
+	return ~timer_read(timer_secondary_base(PLATFORM_TIMER0_VBASE));
+}
+
+static struct clocksource platform_clocksource = {
+	.name = "sp804",
+	.read = platform_clock_read,
+	.freq = 1000000,
+};
+
 void init_platform_timer(void)
 {
 	add_boot_mapping(PLATFORM_TIMER0_BASE, PLATFORM_TIMER0_VBASE,
 			 PAGE_SIZE, MAP_IO_DEFAULT);
 
-	/* 1 Mhz means can tick up to 1,000,000 times a second */
-	timer_init(PLATFORM_TIMER0_VBASE, 1000000 / CONFIG_SCHED_TICKS);
+	timer_init(PLATFORM_TIMER0_VBASE, PLATFORM_TIMER_TICK_LOAD);
+
+	timer_init_freerunning(timer_secondary_base(PLATFORM_TIMER0_VBASE));
+	timer_start(timer_secondary_base(PLATFORM_TIMER0_VBASE));
+	clocksource_register(&platform_clocksource);
+}
+
+static unsigned int timer_oneshot_load;
+static unsigned int timer_oneshot_phase;
+
+/*
+ * Stop the periodic tick and fire a single irq after
+ * given number of scheduler ticks, counted from the last
+ * tick so that the part of a tick already passed is kept.
+ *
+ * Irqs are disabled here, so a tick may have expired without
+ * being taken. Starting the one shot clears it, so it is
+ * counted into the phase and caught up on return to periodic.
+ * The expiry is read on both sides of the count, which then
+ * belongs to the same period.
+ */
+void platform_timer_oneshot(unsigned int ticks)
+{
+	unsigned int phase, deadline;
+	int pending;
+
+	do {
+		pending = timer_irq_raw(PLATFORM_TIMER0_VBASE);
+		phase = PLATFORM_TIMER_TICK_LOAD -
+			timer_read(PLATFORM_TIMER0_VBASE);
+	} while (pending != timer_irq_raw(PLATFORM_TIMER0_VBASE));
+
+	if (phase >= PLATFORM_TIMER_TICK_LOAD)
+		phase = PLATFORM_TIMER_TICK_LOAD - 1;
+	if (pending)
+		phase += PLATFORM_TIMER_TICK_LOAD;
+
+	/* A deadline already due fires right away */
+	deadline = ticks * PLATFORM_TIMER_TICK_LOAD;
+
+	timer_oneshot_phase = phase;
+	timer_oneshot_load = deadline > phase ? deadline - phase : 1;
+	timer_start_oneshot(PLATFORM_TIMER0_VBASE, timer_oneshot_load);
+}
+
+/*
+ * Go back to periodic ticks after a one shot.
+ *
+ * Returns the number of whole ticks that have passed since
+ * the last tick taken before the one shot. The remainder is
+ * carried by cutting the first period short, so ticks stay in
+ * phase and jiffies do not fall behind over idle periods. An irq
+ * raised by an expired one shot is cleared as it is accounted
+ * for here.
+ */
+unsigned int platform_timer_periodic(void)
+{
+	unsigned int elapsed;
+
+	elapsed = timer_oneshot_phase + timer_oneshot_load -
+		  timer_read(PLATFORM_TIMER0_VBASE);
+
+	timer_stop(PLATFORM_TIMER0_VBASE);
+	timer_irq_clear(PLATFORM_TIMER0_VBASE);
+	timer_init_periodic_phase(PLATFORM_TIMER0_VBASE,
+				  PLATFORM_TIMER_TICK_LOAD,
+				  PLATFORM_TIMER_TICK_LOAD -
+				  elapsed % PLATFORM_TIMER_TICK_LOAD);
+	timer_start(PLATFORM_TIMER0_VBASE);
+
+	return elapsed / PLATFORM_TIMER_TICK_LOAD;
 }
 
 void init_platform_irq_controller()
@@ -0,0 +1,152 @@
+#!/usr/bin/python
+#
+# Decodes kernel trace rings (CONFIG_DEBUG_TRACE) into a timeline.
+#
+# The rings are taken from a running or stopped kernel without going
+# over the uart, e.g. in the gdb session started with tools/gdbinit:
+#
+#	(gdb) dump binary value trace.bin trace_pages
+#
+# Events of all cpus in the dump are merged and printed in time order.
+#
+# Usage: tracedump.py [-b] [-c category,...] <dump> [dump ...]
+#
+import sys
+import struct
+import getopt
+
+PAGE_SIZE = 4096
+TRACE_MAGIC = 0x31435254
+TRACE_EVENTS = 1024
+HEADER_FORMAT = "8I"
+EVENT_FORMAT = "4I"
+
+# Must match include/l4/api/trace.h
+categories = ["syscall", "ipc", "sched", "pfault", "irq", "mutex"]
+
+event_names = {
+	(0, 0) : ("syscall_enter", "offset"),
+	(0, 1) : ("syscall_exit", "ret"),
+	(1, 0) : ("ipc_send", "to"),
+	(1, 1) : ("ipc_recv", "from"),
+	(2, 0) : ("switch", "next"),
+	(3, 0) : ("pfault_ipc", "addr"),
+	(4, 0) : ("irq_enter", "irq"),
+	(4, 1) : ("irq_exit", "irq"),
+	(5, 0) : ("mutex_wait", "mutex"),
+	(5, 1) : ("mutex_woken", "mutex"),
+}
+
+class trace_ring:
+	def __init__(self, cpu, head, mask, clock_hz, events):
+		self.cpu = cpu
+		self.head = head
+		self.mask = mask
+		self.clock_hz = clock_hz
+		self.events = events
+
+def parse_rings(data, endian):
+	'''
+	Finds trace rings at page boundaries of a dump, and returns
+	the valid events of each in the order they were written.
+	'''
+	rings = []
+	hsize = struct.calcsize(endian + HEADER_FORMAT)
+	esize = struct.calcsize(endian + EVENT_FORMAT)
+	rsize = hsize + esize * TRACE_EVENTS
+
+	for offset in range(0, len(data) - rsize + 1, PAGE_SIZE):
+		header = struct.unpack_from(endian + HEADER_FORMAT, data, offset)
+		magic, cpu, head, mask, clock_hz = header[:5]
+		if magic != TRACE_MAGIC:
+			continue
+
+		start = max(0, head - TRACE_EVENTS)
+		events = []
+		for n in range(start, head):
+			slot = n & (TRACE_EVENTS - 1)
+			events.append(struct.unpack_from(endian + EVENT_FORMAT, data,
+							  offset + hsize +
+							  slot * esize))
+		rings.append(trace_ring(cpu, head, mask, clock_hz, events))
+	return rings
+
+def unwrap_stamps(events):
+	'''
+	Stamps are 32-bit clock counts. Events of a ring are in write
+	order, so each wrap shows up as a stamp going backwards.
+	'''
+	base = 0
+	last = None
+	result = []
+	for stamp, etype, tid, arg in events:
+		if last is not None and stamp < last:
+			base += 1 << 32
+		last = stamp
+		result.append((base + stamp, etype, tid, arg))
+	return result
+
+def describe(etype, arg):
+	cat, n = etype >> 8, etype & 0xFF
+	if (cat, n) not in event_names:
+		return "unknown(0x%x)" % etype, "0x%x" % arg
+	name, argname = event_names[(cat, n)]
+	if argname in ("addr", "mutex", "offset"):
+		return name, "%s=0x%x" % (argname, arg)
+	if argname == "ret":
+		return name, "%s=%d" % (argname, struct.unpack("i",
+						struct.pack("I", arg))[0])
+	return name, "%s=%d" % (argname, arg)
+
+def usage():
+	print("Usage: %s [-b] [-c category,...] <dump> [dump ...]" % sys.argv[0])
+	print("  -b  Dump is from a big-endian target")
+	print("  -c  Only show the given categories: %s" % ",".join(categories))
+	sys.exit(1)
+
+def main():
+	try:
+		opts, args = getopt.getopt(sys.argv[1:], "bc:")
+	except getopt.GetoptError:
+		usage()
+	if not args:
+		usage()
+
+	endian = "<"
+	shown = set(range(len(categories)))
+	for opt, val in opts:
+		if opt == "-b":
+			endian = ">"
+		elif opt == "-c":
+			shown = set([categories.index(c) for c in val.split(",")])
+
+	timeline = []
+	clock_hz = 0
+	for path in args:
+		data = open(path, "rb").read()
+		for ring in parse_rings(data, endian):
+			clock_hz = clock_hz or ring.clock_hz
+			print("cpu%d: %d events written, %d in ring, mask 0x%x" %
+			      (ring.cpu, ring.head, len(ring.events), ring.mask))
+			for event in unwrap_stamps(ring.events):
+				timeline.append((event[0], ring.cpu) + event[1:])
+
+	if not timeline:
+		print("No trace rings found.")
+		return
+
+	timeline.sort()
+	first = timeline[0][0]
+	for stamp, cpu, etype, tid, arg in timeline:
+		if (etype >> 8) not in shown:
+			continue
+		delta = stamp - first
+		if clock_hz:
+			when = "%12.3f us" % (delta * 1000000.0 / clock_hz)
+		else:
+			when = "%12d" % delta
+		name, argstr = describe(etype, arg)
+		print("%s cpu%d tid %-8d %-14s %s" % (when, cpu, tid, name, argstr))
+
+if __name__ == "__main__":
+	main()